@@ -0,0 +1,702 @@
+/**
+ * Benchmarks for the optional modes of BinarySearchTree
+ *
+ * Build: g++ -O2 -std=c++11 -pthread -I. bench.cpp bst.cpp intervaltree.cpp
+ *           durabletree.cpp shardedtree.cpp traversalsink.cpp bloomfilter.cpp
+ *           compressedkeyset.cpp -o bench
+ * Run:   ./bench [splay | buffered | sharded | filter | compressed |
+ *           interval | durable [directory]]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "bst.h"
+#include "intervaltree.h"
+#include "durabletree.h"
+#include "shardedtree.h"
+#include "bloomfilter.h"
+#include "compressedkeyset.h"
+
+using namespace std;
+
+const int BENCH_KEYS = 1000000;
+const int BENCH_LOOKUPS = 5000000;
+const double ZIPF_EXPONENTS[] = { 0.99, 1.3 };
+const int SPLAY_PASSES = 3;
+const int BUFFER_LIMITS[] = { 1024, 4096, 16384, 65536, 262144 };
+const int WRITER_COUNTS[] = { 1, 2, 4, 8 };
+const int BENCH_SHARDS = 64;
+const double MISS_FRACTION = 0.7;
+const double FALSE_POSITIVE_RATES[] = { 0.01, 0.001, 0.0001 };
+const int KEY_SPREADS[] = { 1, 1000 };  // keys are scaled by these, with random gaps
+const int BENCH_INTERVALS = 1000000;
+const int BENCH_QUERIES = 20000;
+const int INTERVAL_SPAN = 1000000000;  // starts are drawn from [0, INTERVAL_SPAN)
+const int INTERVAL_LENGTH = 100000;    // ends lie at most this far past starts
+const int QUERY_LENGTH = 10000;
+const int DURABLE_KEYS = 1000000;
+const int DURABLE_SYNCED_KEYS = 2000;  // SYNC_ALWAYS pays an fdatasync per key
+
+/*****************************************************************************/
+/********************** Helpers **********************************************/
+/*****************************************************************************/
+
+/**
+* Draw the next pseudo-random number (xorshift64*)
+*
+* Precondition: state is not 0
+* Postcondition: state has advanced and the next number is returned
+*/
+
+static unsigned long long nextRandom(unsigned long long& state)
+{
+	state ^= state >> 12;
+	state ^= state << 25;
+	state ^= state >> 27;
+	return state * 2685821657736338717ULL;
+}
+
+/**
+* Determine the seconds elapsed since start
+*/
+
+static double elapsedSeconds(const chrono::steady_clock::time_point& start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+* Shuffle count distinct keys spread over the positive integers
+*
+* Postcondition: keys holds count distinct keys in random order
+*/
+
+static void makeKeys(int count, unsigned long long seed, vector<DataType>& keys)
+{
+	keys.resize(count);
+	for (int i = 0; i < count; i++) {
+		keys[i] = i * 2 + 1;
+	}
+	for (int i = count - 1; i > 0; i--) {
+		swap(keys[i], keys[nextRandom(seed) % (i + 1)]);
+	}
+}
+
+/**
+* Report one benchmark result
+*/
+
+static void report(const string& name, double seconds, int operations)
+{
+	cout << left << setw(36) << name << right << fixed << setprecision(1)
+		<< setw(10) << seconds * 1e9 / operations << " ns/op"
+		<< setw(12) << setprecision(2) << operations / seconds / 1e6 << " Mop/s" << endl;
+}
+
+/*****************************************************************************/
+/********************** Self-Adjusting Mode **********************************/
+/*****************************************************************************/
+
+/**
+* Zipfian lookups: search on the plain tree against access in self-adjusting
+* mode. Both trees are built from the same random insertion order, and the
+* hot keys sit at random depths
+*/
+
+static void benchSplay(double exponent)
+{
+	vector<DataType> keys;
+	makeKeys(BENCH_KEYS, 88172645463325252ULL, keys);
+
+	// rank keys independently of insertion order, so that the hot keys are
+	// not simply the ones inserted first, near the root of the plain tree
+	vector<DataType> ranked;
+	makeKeys(BENCH_KEYS, 5573589319906701683ULL, ranked);
+
+	// cumulative Zipf distribution over key ranks
+	vector<double> cdf(BENCH_KEYS);
+	double total = 0;
+	for (int i = 0; i < BENCH_KEYS; i++) {
+		total += 1.0 / pow(i + 1.0, exponent);
+		cdf[i] = total;
+	}
+
+	unsigned long long seed = 1442695040888963407ULL;
+	vector<DataType> lookups(BENCH_LOOKUPS);
+	for (int i = 0; i < BENCH_LOOKUPS; i++) {
+		double u = (nextRandom(seed) >> 11) * (1.0 / 9007199254740992.0) * total;
+		int rank = (int)(lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+		lookups[i] = ranked[rank < BENCH_KEYS ? rank : BENCH_KEYS - 1];
+	}
+
+	BinarySearchTree plain;
+	BinarySearchTree adjusting;
+	adjusting.setSelfAdjusting(true);
+	for (int i = 0; i < BENCH_KEYS; i++) {
+		plain.insert(keys[i]);
+		adjusting.insert(keys[i]);
+	}
+
+	cout << "Zipfian lookups (s = " << exponent << ", " << BENCH_KEYS
+		<< " keys, height " << plain.getHeight() << ")" << endl;
+
+	// alternate the trees and keep each one's best pass, so that the
+	// self-adjusting tree is timed once it has adapted and noise from the
+	// rest of the machine hits both alike
+	double plainBest = 0;
+	double adjustingBest = 0;
+	int found = 0;
+	for (int pass = 0; pass < SPLAY_PASSES; pass++) {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		for (int i = 0; i < BENCH_LOOKUPS; i++) {
+			found += plain.search(lookups[i]);
+		}
+		double seconds = elapsedSeconds(start);
+		if (pass == 0 || seconds < plainBest) {
+			plainBest = seconds;
+		}
+
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < BENCH_LOOKUPS; i++) {
+			found += adjusting.access(lookups[i]);
+		}
+		seconds = elapsedSeconds(start);
+		if (pass == 0 || seconds < adjustingBest) {
+			adjustingBest = seconds;
+		}
+	}
+	report("  search, plain tree", plainBest, BENCH_LOOKUPS);
+	report("  access, self-adjusting tree", adjustingBest, BENCH_LOOKUPS);
+
+	if (found != 2 * SPLAY_PASSES * BENCH_LOOKUPS) {
+		cout << "  MISMATCH: " << found << " hits" << endl;
+	}
+}
+
+/*****************************************************************************/
+/********************** Buffered Mode ****************************************/
+/*****************************************************************************/
+
+/**
+* Time a bulk load of keys into an empty tree, buffered with limit, or plain
+* when limit is 0
+*/
+
+static double timeBulkLoad(const vector<DataType>& keys, int limit)
+{
+	BinarySearchTree tree;
+	if (limit > 0) {
+		tree.setBufferLimit(limit);
+		tree.setBuffered(true);
+	}
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_KEYS; i++) {
+		tree.insert(keys[i]);
+	}
+	tree.flush();
+	return elapsedSeconds(start);
+}
+
+/**
+* Time steady-state churn on a tree of BENCH_KEYS items: every step inserts
+* a new key and removes an old one. Buffered with limit, or plain when limit
+* is 0
+*/
+
+static double timeChurn(const vector<DataType>& keys, int limit)
+{
+	BinarySearchTree tree;
+	for (int i = 0; i < BENCH_KEYS; i++) {
+		tree.insert(keys[i]);
+	}
+	if (limit > 0) {
+		tree.setBufferLimit(limit);
+		tree.setBuffered(true);
+	}
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_KEYS; i++) {
+		tree.insert(keys[BENCH_KEYS + i]);
+		tree.remove(keys[i]);
+	}
+	tree.flush();
+	double seconds = elapsedSeconds(start);
+
+	if (tree.getSize() != BENCH_KEYS) {
+		cout << "  MISMATCH: " << tree.getSize() << " items" << endl;
+	}
+	return seconds;
+}
+
+/**
+* Random inserts, and insert/remove churn, with plain inserts against
+* buffered mode at several buffer limits
+*/
+
+static void benchBuffered()
+{
+	vector<DataType> keys;
+	makeKeys(2 * BENCH_KEYS, 7046029254386353131ULL, keys);
+
+	cout << "Bulk load of " << BENCH_KEYS << " random keys" << endl;
+	report("  insert, plain", timeBulkLoad(keys, 0), BENCH_KEYS);
+	for (size_t i = 0; i < sizeof(BUFFER_LIMITS) / sizeof(BUFFER_LIMITS[0]); i++) {
+		ostringstream name;
+		name << "  insert, buffered " << BUFFER_LIMITS[i];
+		report(name.str(), timeBulkLoad(keys, BUFFER_LIMITS[i]), BENCH_KEYS);
+	}
+
+	cout << "Insert + remove churn on " << BENCH_KEYS << " keys" << endl;
+	report("  insert/remove, plain", timeChurn(keys, 0), 2 * BENCH_KEYS);
+	for (size_t i = 0; i < sizeof(BUFFER_LIMITS) / sizeof(BUFFER_LIMITS[0]); i++) {
+		ostringstream name;
+		name << "  insert/remove, buffered " << BUFFER_LIMITS[i];
+		report(name.str(), timeChurn(keys, BUFFER_LIMITS[i]), 2 * BENCH_KEYS);
+	}
+}
+
+/*****************************************************************************/
+/********************** Sharded Tree *****************************************/
+/*****************************************************************************/
+
+/**
+* Insert keys from several writer threads, each taking an equal slice, into
+* one tree behind a mutex when sharded is NULL, or into sharded
+*/
+
+static double timeWriters(const vector<DataType>& keys, int writers, ShardedTree * sharded)
+{
+	BinarySearchTree tree;
+	mutex treeLock;
+	int slice = BENCH_KEYS / writers;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<thread> threads;
+	for (int w = 0; w < writers; w++) {
+		threads.push_back(thread([&, w]() {
+			for (int i = w * slice; i < (w + 1) * slice; i++) {
+				if (sharded != NULL) {
+					sharded->insert(keys[i]);
+				} else {
+					lock_guard<mutex> guard(treeLock);
+					tree.insert(keys[i]);
+				}
+			}
+		}));
+	}
+	for (int w = 0; w < writers; w++) {
+		threads[w].join();
+	}
+	double seconds = elapsedSeconds(start);
+
+	int size = (sharded != NULL) ? sharded->getSize() : tree.getSize();
+	if (size != slice * writers) {
+		cout << "  MISMATCH: " << size << " items, expected " << slice * writers << endl;
+	}
+	return seconds;
+}
+
+/**
+* Write scaling: random inserts from 1, 2, 4 and 8 threads into a single
+* tree behind a mutex against a sharded tree
+*/
+
+static void benchSharded()
+{
+	vector<DataType> keys;
+	makeKeys(BENCH_KEYS, 1181783497276652981ULL, keys);
+
+	cout << "Random inserts of " << BENCH_KEYS << " keys ("
+		<< thread::hardware_concurrency() << " hardware threads, "
+		<< BENCH_SHARDS << " shards)" << endl;
+
+	for (size_t i = 0; i < sizeof(WRITER_COUNTS) / sizeof(WRITER_COUNTS[0]); i++) {
+		int writers = WRITER_COUNTS[i];
+
+		ostringstream name;
+		name << "  mutex tree, " << writers << (writers == 1 ? " writer" : " writers");
+		report(name.str(), timeWriters(keys, writers, NULL), BENCH_KEYS / writers * writers);
+
+		ShardedTree sharded(1, 2 * BENCH_KEYS, BENCH_SHARDS);
+		name.str("");
+		name << "  sharded tree, " << writers << (writers == 1 ? " writer" : " writers");
+		report(name.str(), timeWriters(keys, writers, &sharded), BENCH_KEYS / writers * writers);
+	}
+}
+
+/*****************************************************************************/
+/********************** Negative Lookup Filter *******************************/
+/*****************************************************************************/
+
+/**
+* Miss-heavy lookups: search without a filter against search behind counting
+* Bloom filters at several false positive rates. Keys are odd, so every even
+* lookup is a miss. The rate each filter achieves is measured on the misses
+* with a stand-alone filter of the same size
+*/
+
+static void benchFilter()
+{
+	vector<DataType> keys;
+	makeKeys(BENCH_KEYS, 3935559000370003845ULL, keys);
+
+	unsigned long long seed = 2685821657736338717ULL;
+	vector<DataType> lookups(BENCH_LOOKUPS);
+	int misses = 0;
+	for (int i = 0; i < BENCH_LOOKUPS; i++) {
+		DataType key = keys[nextRandom(seed) % BENCH_KEYS];
+		if ((nextRandom(seed) >> 11) * (1.0 / 9007199254740992.0) < MISS_FRACTION) {
+			key++;
+			misses++;
+		}
+		lookups[i] = key;
+	}
+
+	BinarySearchTree tree;
+	for (int i = 0; i < BENCH_KEYS; i++) {
+		tree.insert(keys[i]);
+	}
+
+	cout << "Lookups with " << (int)(MISS_FRACTION * 100) << "% misses (" << BENCH_KEYS
+		<< " keys, height " << tree.getHeight() << ")" << endl;
+
+	int expected = BENCH_LOOKUPS - misses;
+	int found = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_LOOKUPS; i++) {
+		found += tree.search(lookups[i]);
+	}
+	report("  search, no filter", elapsedSeconds(start), BENCH_LOOKUPS);
+
+	for (size_t r = 0; r < sizeof(FALSE_POSITIVE_RATES) / sizeof(FALSE_POSITIVE_RATES[0]); r++) {
+		CountingBloomFilter filter(BENCH_KEYS, FALSE_POSITIVE_RATES[r]);
+		for (int i = 0; i < BENCH_KEYS; i++) {
+			filter.add(keys[i]);
+		}
+		int falsePositives = 0;
+		for (int i = 0; i < BENCH_LOOKUPS; i++) {
+			if (lookups[i] % 2 == 0 && filter.mayContain(lookups[i])) {
+				falsePositives++;
+			}
+		}
+
+		tree.enableFilter(BENCH_KEYS, FALSE_POSITIVE_RATES[r]);
+
+		found = 0;
+		start = chrono::steady_clock::now();
+		for (int i = 0; i < BENCH_LOOKUPS; i++) {
+			found += tree.search(lookups[i]);
+		}
+
+		ostringstream name;
+		name << "  search, filter at " << FALSE_POSITIVE_RATES[r] * 100 << "%";
+		report(name.str(), elapsedSeconds(start), BENCH_LOOKUPS);
+		cout << "    achieved " << setprecision(4) << 100.0 * falsePositives / misses
+			<< "% false positives, " << setprecision(2) << filter.getCounterCount() / 2.0 / BENCH_KEYS
+			<< " bytes/key, " << filter.getHashCount() << " probes" << endl;
+	}
+
+	if (found != expected) {
+		cout << "  MISMATCH: " << found << " hits, expected " << expected << endl;
+	}
+}
+
+/*****************************************************************************/
+/********************** Compressed Key Set ***********************************/
+/*****************************************************************************/
+
+/**
+* Export a tree into a compressed key set and report its size, then time
+* search and getSuccessor on the key set against the same calls on the tree.
+* Each key k becomes k * spread plus a random offset below spread, so the
+* gaps average 2 * spread. Searches are half hits and half misses;
+* getSuccessor on the tree requires a present key below the largest, so both
+* structures are asked for successors of those keys only
+*/
+
+static void benchCompressed(int spread)
+{
+	vector<DataType> keys;
+	makeKeys(BENCH_KEYS, 1181783497276652981ULL, keys);
+
+	unsigned long long seed = 7046029254386353131ULL;
+	DataType largest = 0;
+	for (int i = 0; i < BENCH_KEYS; i++) {
+		keys[i] = keys[i] * spread + (DataType)(nextRandom(seed) % spread);
+		largest = max(largest, keys[i]);
+	}
+
+	vector<DataType> lookups(BENCH_LOOKUPS);
+	vector<DataType> present(BENCH_LOOKUPS);
+	for (int i = 0; i < BENCH_LOOKUPS; i++) {
+		do {
+			present[i] = keys[nextRandom(seed) % BENCH_KEYS];
+		} while (present[i] == largest);
+		lookups[i] = present[i] + (DataType)(nextRandom(seed) & 1);
+	}
+
+	BinarySearchTree tree;
+	for (int i = 0; i < BENCH_KEYS; i++) {
+		tree.insert(keys[i]);
+	}
+
+	CompressedKeySet compressed;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	tree.compress(compressed);
+	double seconds = elapsedSeconds(start);
+
+	cout << "Compressed key set (" << BENCH_KEYS << " keys, mean gap " << spread * 2
+		<< ", height " << tree.getHeight() << ")" << endl;
+	cout << left << setw(36) << "  export" << right << fixed << setprecision(1)
+		<< setw(10) << seconds * 1e3 << " ms   " << setprecision(2)
+		<< compressed.getBytesPerKey() << " bytes/key" << endl;
+
+	int treeFound = 0;
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_LOOKUPS; i++) {
+		treeFound += tree.search(lookups[i]);
+	}
+	report("  search, tree", elapsedSeconds(start), BENCH_LOOKUPS);
+
+	int compressedFound = 0;
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_LOOKUPS; i++) {
+		compressedFound += compressed.search(lookups[i]);
+	}
+	report("  search, compressed", elapsedSeconds(start), BENCH_LOOKUPS);
+
+	long long treeSum = 0;
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_LOOKUPS; i++) {
+		treeSum += tree.getSuccessor(present[i]);
+	}
+	report("  getSuccessor, tree", elapsedSeconds(start), BENCH_LOOKUPS);
+
+	long long compressedSum = 0;
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_LOOKUPS; i++) {
+		DataType successor;
+		if (compressed.getSuccessor(present[i], successor)) {
+			compressedSum += successor;
+		}
+	}
+	report("  getSuccessor, compressed", elapsedSeconds(start), BENCH_LOOKUPS);
+
+	if (treeFound != compressedFound || treeSum != compressedSum) {
+		cout << "  MISMATCH: " << compressedFound << " hits, expected " << treeFound << endl;
+	}
+}
+
+/*****************************************************************************/
+/********************** Interval Tree ****************************************/
+/*****************************************************************************/
+
+/**
+* Overlap queries: findOverlapping on an interval tree against a linear scan
+* of the same intervals held in a vector
+*/
+
+static void benchInterval()
+{
+	unsigned long long seed = 6364136223846793005ULL;
+	IntervalTree tree;
+	vector<Interval> intervals;
+
+	while ((int)intervals.size() < BENCH_INTERVALS) {
+		Interval interval;
+		interval.start = (DataType)(nextRandom(seed) % INTERVAL_SPAN);
+		interval.end = interval.start + (DataType)(nextRandom(seed) % INTERVAL_LENGTH);
+		if (tree.insertInterval(interval.start, interval.end)) {
+			intervals.push_back(interval);
+		}
+	}
+
+	vector<DataType> lows(BENCH_QUERIES);
+	for (int i = 0; i < BENCH_QUERIES; i++) {
+		lows[i] = (DataType)(nextRandom(seed) % INTERVAL_SPAN);
+	}
+
+	cout << "Overlap queries (" << BENCH_INTERVALS << " intervals, windows of "
+		<< QUERY_LENGTH << ")" << endl;
+
+	// the scan is far slower, so it answers a tenth of the queries
+	int scanQueries = BENCH_QUERIES / 10;
+	long long scanned = 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < scanQueries; i++) {
+		DataType low = lows[i];
+		DataType high = low + QUERY_LENGTH;
+		for (size_t j = 0; j < intervals.size(); j++) {
+			if (!(high < intervals[j].start) && !(intervals[j].end < low)) {
+				scanned++;
+			}
+		}
+	}
+	report("  linear scan", elapsedSeconds(start), scanQueries);
+
+	long long found = 0;
+	long long foundPrefix = 0;
+	vector<Interval> result;
+	start = chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_QUERIES; i++) {
+		result.clear();
+		tree.findOverlapping(lows[i], lows[i] + QUERY_LENGTH, result);
+		found += result.size();
+		if (i < scanQueries) {
+			foundPrefix += result.size();
+		}
+	}
+	report("  findOverlapping", elapsedSeconds(start), BENCH_QUERIES);
+
+	cout << "  " << fixed << setprecision(1) << (double)found / BENCH_QUERIES
+		<< " intervals per query" << endl;
+	if (foundPrefix != scanned) {
+		cout << "  MISMATCH: " << foundPrefix << " against " << scanned << endl;
+	}
+}
+
+/*****************************************************************************/
+/********************** Durable Tree *****************************************/
+/*****************************************************************************/
+
+/**
+* Remove the files a durable tree keeps in directory
+*/
+
+static void removeDurableFiles(const string& directory)
+{
+	::unlink((directory + "/wal.log").c_str());
+	::unlink((directory + "/checkpoint").c_str());
+	::unlink((directory + "/checkpoint.tmp").c_str());
+}
+
+/**
+* Time inserts of count random keys into a fresh durable tree
+*/
+
+static void benchDurableWrites(const string& directory, const vector<DataType>& keys, int count,
+	SyncPolicy policy, const string& name)
+{
+	removeDurableFiles(directory);
+	DurableTree tree(directory, policy);
+	tree.open();
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < count; i++) {
+		tree.insert(keys[i]);
+	}
+	tree.sync();
+	report(name, elapsedSeconds(start), count);
+}
+
+/**
+* Time recovery of a durable tree from directory
+*/
+
+static void benchRecovery(const string& directory, const string& name)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	DurableTree tree(directory, SYNC_NONE);
+	tree.open();
+	double seconds = elapsedSeconds(start);
+
+	cout << left << setw(36) << name << right << fixed << setprecision(1)
+		<< setw(10) << seconds * 1e3 << " ms   " << tree.getTree().getSize() << " keys, "
+		<< tree.getReplayedCount() << " log records" << endl;
+}
+
+/**
+* Write throughput at each sync policy against the in-memory tree, and
+* recovery time from a long log and from a checkpoint with a short tail
+*/
+
+static void benchDurable(const string& directory)
+{
+	vector<DataType> keys;
+	makeKeys(DURABLE_KEYS, 2862933555777941757ULL, keys);
+
+	cout << "Durable inserts (log in " << directory << ")" << endl;
+
+	BinarySearchTree memory;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (int i = 0; i < DURABLE_KEYS; i++) {
+		memory.insert(keys[i]);
+	}
+	report("  in-memory tree", elapsedSeconds(start), DURABLE_KEYS);
+
+	benchDurableWrites(directory, keys, DURABLE_KEYS, SYNC_NONE, "  SYNC_NONE");
+	benchDurableWrites(directory, keys, DURABLE_KEYS, SYNC_GROUP, "  SYNC_GROUP (256)");
+	benchDurableWrites(directory, keys, DURABLE_SYNCED_KEYS, SYNC_ALWAYS, "  SYNC_ALWAYS");
+
+	cout << "Recovery" << endl;
+
+	// the whole key set in the log
+	benchDurableWrites(directory, keys, DURABLE_KEYS, SYNC_NONE, "  (writing log)");
+	benchRecovery(directory, "  log replay");
+
+	// the key set in a checkpoint and a tenth of it in the log tail
+	{
+		DurableTree tree(directory, SYNC_NONE);
+		tree.open();
+		tree.checkpoint();
+		for (int i = 0; i < DURABLE_KEYS / 10; i++) {
+			tree.remove(keys[i]);
+		}
+	}
+	benchRecovery(directory, "  checkpoint + log tail");
+
+	removeDurableFiles(directory);
+}
+
+int main(int argc, char * argv[])
+{
+	string mode = (argc > 1) ? argv[1] : "all";
+
+	if (mode == "all" || mode == "splay") {
+		for (size_t i = 0; i < sizeof(ZIPF_EXPONENTS) / sizeof(ZIPF_EXPONENTS[0]); i++) {
+			benchSplay(ZIPF_EXPONENTS[i]);
+		}
+	}
+
+	if (mode == "all" || mode == "buffered") {
+		benchBuffered();
+	}
+
+	if (mode == "all" || mode == "sharded") {
+		benchSharded();
+	}
+
+	if (mode == "all" || mode == "filter") {
+		benchFilter();
+	}
+
+	if (mode == "all" || mode == "compressed") {
+		for (size_t i = 0; i < sizeof(KEY_SPREADS) / sizeof(KEY_SPREADS[0]); i++) {
+			benchCompressed(KEY_SPREADS[i]);
+		}
+	}
+
+	if (mode == "all" || mode == "interval") {
+		benchInterval();
+	}
+
+	if (mode == "all" || mode == "durable") {
+		string directory = (argc > 2) ? argv[2] : "bench-durable";
+		benchDurable(directory);
+		::rmdir(directory.c_str());
+	}
+
+	return 0;
+}
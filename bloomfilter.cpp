@@ -0,0 +1,250 @@
+#include "bloomfilter.h"
+#include <cmath>
+
+using namespace std;
+
+// counters stop changing once they reach this value
+static const int SATURATED = 15;
+
+// most probes per item
+static const int MAX_HASH_COUNT = 16;
+
+// growth of the filter per sizing step while the blocked rate is too high
+static const double SIZING_STEP = 1.05;
+
+// each probe multiplies the hash by this and reads the top bits
+static const HashType PROBE_MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+
+/**
+* Expected false positive rate of a blocked filter. The number of items in a
+* block is Poisson distributed, and a block holding j items answers a miss
+* wrongly with the rate of a plain filter of BLOOM_BLOCK_SIZE counters
+*
+* Precondition: itemsPerBlock is positive. hashCount is positive
+* Postcondition: Returns the expected false positive rate
+*
+* Worst-Case Time Complexity: O(sqrt(itemsPerBlock))
+*/
+
+static double blockedRate(double itemsPerBlock, int hashCount)
+{
+	double spread = 12 * sqrt(itemsPerBlock) + 30;
+	int first = (int)(itemsPerBlock - spread);
+	if (first < 0) {
+		first = 0;
+	}
+	int last = (int)(itemsPerBlock + spread);
+
+	double rate = 0;
+	for (int j = first; j <= last; j++) {
+		double weight = exp(-itemsPerBlock + j * log(itemsPerBlock) - lgamma(j + 1.0));
+		double filled = 1 - pow(1 - 1.0 / BLOOM_BLOCK_SIZE, (double)hashCount * j);
+		rate += weight * pow(filled, hashCount);
+	}
+	return rate;
+}
+
+/*****************************************************************************/
+/********************** Constructors *****************************************/
+/*****************************************************************************/
+
+/**
+* Construct a filter sized for a number of items and false positive rate.
+* Blocking raises the rate above that of a plain filter of the same size,
+* by more the lower the rate, so the size starts at the plain filter's
+* m = -n ln(p) / ln(2)^2 counters and grows until the expected blocked rate,
+* with the best number of probes, meets the target
+*
+* Precondition: expectedItems is positive. 0 < falsePositiveRate < 1
+* Postcondition: An empty filter holding expectedItems items at no more than
+*    falsePositiveRate (up to one block per item) has been constructed
+*
+* Worst-Case Time Complexity: O(m)
+*/
+
+CountingBloomFilter::CountingBloomFilter(int expectedItems, double falsePositiveRate)
+{
+	double ln2 = log(2.0);
+	double counters = -expectedItems * log(falsePositiveRate) / (ln2 * ln2);
+
+	int blocks = (int)ceil(counters / BLOOM_BLOCK_SIZE);
+	if (blocks < 1) {
+		blocks = 1;
+	}
+
+	_hashCount = 1;
+	while (true) {
+		double itemsPerBlock = (double)expectedItems / blocks;
+
+		double rate = 1;
+		for (int k = 1; k <= MAX_HASH_COUNT; k++) {
+			double kRate = blockedRate(itemsPerBlock, k);
+			if (kRate < rate) {
+				rate = kRate;
+				_hashCount = k;
+			}
+		}
+
+		if (rate <= falsePositiveRate || blocks >= expectedItems) {
+			break;
+		}
+		blocks = (int)ceil(blocks * SIZING_STEP);
+	}
+
+	_counters.assign((size_t)blocks * BLOOM_BLOCK_SIZE / 2, 0);
+	_blockCount = blocks;
+}
+
+/*****************************************************************************/
+/********************** Accessors ********************************************/
+/*****************************************************************************/
+
+/**
+* Check whether an item may be in the set
+*
+* Precondition: None
+* Postcondition: Returns false only if item is definitely not in the set
+*
+* Worst-Case Time Complexity: O(k), within a single cache line
+*/
+
+bool CountingBloomFilter::mayContain(const DataType& item) const
+{
+	HashType h = hashItem(item);
+	size_t block = (size_t)(((h >> 32) * _blockCount) >> 32) * BLOOM_BLOCK_SIZE;
+
+	for (int i = 0; i < _hashCount; i++) {
+		h *= PROBE_MULTIPLIER;
+		if (getCounter(block + (size_t)(((h >> 32) * BLOOM_BLOCK_SIZE) >> 32)) == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* Determine the number of probes per item
+*
+* Precondition: None
+* Postcondition: Returns the number of counters each item touches
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int CountingBloomFilter::getHashCount() const
+{
+	return _hashCount;
+}
+
+/**
+* Determine the number of counters in the filter
+*
+* Precondition: None
+* Postcondition: Returns the number of counters, two per byte
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int CountingBloomFilter::getCounterCount() const
+{
+	return (int)_counters.size() * 2;
+}
+
+/*****************************************************************************/
+/********************** Operations *******************************************/
+/*****************************************************************************/
+
+/**
+* Add an item to the set
+*
+* Precondition: None
+* Postcondition: mayContain(item) returns true until item is removed
+*
+* Worst-Case Time Complexity: O(k)
+*/
+
+void CountingBloomFilter::add(const DataType& item)
+{
+	HashType h = hashItem(item);
+	size_t block = (size_t)(((h >> 32) * _blockCount) >> 32) * BLOOM_BLOCK_SIZE;
+
+	for (int i = 0; i < _hashCount; i++) {
+		h *= PROBE_MULTIPLIER;
+		size_t index = block + (size_t)(((h >> 32) * BLOOM_BLOCK_SIZE) >> 32);
+		int counter = getCounter(index);
+		if (counter != SATURATED) {
+			setCounter(index, counter + 1);
+		}
+	}
+}
+
+/**
+* Remove an item from the set
+*
+* Precondition: item was added and has not been removed since
+* Postcondition: item's counters have been decremented, except saturated ones
+*
+* Worst-Case Time Complexity: O(k)
+*/
+
+void CountingBloomFilter::remove(const DataType& item)
+{
+	HashType h = hashItem(item);
+	size_t block = (size_t)(((h >> 32) * _blockCount) >> 32) * BLOOM_BLOCK_SIZE;
+
+	for (int i = 0; i < _hashCount; i++) {
+		h *= PROBE_MULTIPLIER;
+		size_t index = block + (size_t)(((h >> 32) * BLOOM_BLOCK_SIZE) >> 32);
+		int counter = getCounter(index);
+		if (counter != SATURATED && counter != 0) {
+			setCounter(index, counter - 1);
+		}
+	}
+}
+
+/**
+* Remove every item from the set
+*
+* Precondition: None
+* Postcondition: The filter is empty
+*
+* Worst-Case Time Complexity: O(m)
+*/
+
+void CountingBloomFilter::clear()
+{
+	_counters.assign(_counters.size(), 0);
+}
+
+/*****************************************************************************/
+/********************** Functions ********************************************/
+/*****************************************************************************/
+
+/**
+* Read a 4-bit counter
+*
+* Precondition: index is less than getCounterCount()
+* Postcondition: Returns the value of the counter
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int CountingBloomFilter::getCounter(size_t index) const
+{
+	return (_counters[index / 2] >> ((index % 2) * 4)) & 0x0f;
+}
+
+/**
+* Write a 4-bit counter
+*
+* Precondition: index is less than getCounterCount(). 0 <= value <= 15
+* Postcondition: The counter holds value
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void CountingBloomFilter::setCounter(size_t index, int value)
+{
+	int shift = (index % 2) * 4;
+	_counters[index / 2] = (unsigned char)((_counters[index / 2] & ~(0x0f << shift)) | (value << shift));
+}
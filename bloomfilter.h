@@ -0,0 +1,39 @@
+#ifndef BLOOMFILTER_H_
+#define BLOOMFILTER_H_
+
+#include <vector>
+#include "bst.h"
+
+const int BLOOM_BLOCK_SIZE = 128; // 4-bit counters per 64-byte cache line
+
+/**
+ * Class to hold a blocked counting Bloom filter
+ *
+ * Every item maps to one block of 128 counters, and its probes all fall
+ * inside that block, so a lookup touches a single cache line. Counters are
+ * 4 bits, two to a byte, and saturate: a saturated counter is never
+ * decremented, which can only cost false positives, never false negatives
+ */
+
+class CountingBloomFilter {
+   public:
+      CountingBloomFilter(int, double);
+
+      bool mayContain(const DataType&) const;
+      int getHashCount() const;
+      int getCounterCount() const;
+
+      void add(const DataType&);
+      void remove(const DataType&);
+      void clear();
+
+   private:
+      std::vector<unsigned char> _counters;
+      int _blockCount;
+      int _hashCount;
+
+      int getCounter(size_t) const;
+      void setCounter(size_t, int);
+};
+
+#endif /* BLOOMFILTER_H_ */
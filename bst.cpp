@@ -1,8 +1,41 @@
 #include "bst.h"
+#include "traversalsink.h"
+#include "bloomfilter.h"
+#include "compressedkeyset.h"
 #include <queue>
+#include <algorithm>
 
 using namespace std;
 
+/**
+* Mix an item into 64 well-distributed bits (splitmix64 finalizer). Subtree
+* hashes add these up, so equal key sets hash equally whatever their shape,
+* and the Bloom filter derives its probes from the same bits
+*
+* Precondition: None
+* Postcondition: Returns the hash of item
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+HashType hashItem(const DataType& item)
+{
+	HashType h = (HashType)(long long)item + 0x9e3779b97f4a7c15ULL;
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+	return h ^ (h >> 31);
+}
+
+/**
+* Order buffered operations by key alone, so that a stable sort keeps the
+* operations on one key in arrival order
+*/
+
+static bool pendingKeyLess(const std::pair<DataType, bool>& first, const std::pair<DataType, bool>& second)
+{
+	return first.first < second.first;
+}
+
 /*****************************************************************************/
 /********************** Constructors *****************************************/
 /*****************************************************************************/
@@ -19,6 +52,18 @@ using namespace std;
 BinarySearchTree::BinarySearchTree()
 {
 	_root = NULL;
+	_intervals = false;
+	_selfAdjusting = false;
+	_buffered = false;
+	_bufferLimit = DEFAULT_BUFFER_LIMIT;
+	_filter = NULL;
+	_capacity = 0;
+	_evictionPolicy = EVICT_MINIMUM;
+	_evictionListener = NULL;
+	_threaded = false;
+	_lruHead = NULL;
+	_lruTail = NULL;
+	_clockHand = NULL;
 }
 
 /**
@@ -33,6 +78,19 @@ BinarySearchTree::BinarySearchTree()
 BinarySearchTree::BinarySearchTree(BinarySearchTree& original)
 {
 	_root = new Node();
+	_intervals = false;
+	_selfAdjusting = false;
+	_buffered = false;
+	_bufferLimit = DEFAULT_BUFFER_LIMIT;
+	_filter = NULL;
+	_capacity = 0;
+	_evictionPolicy = EVICT_MINIMUM;
+	_evictionListener = NULL;
+	_threaded = false;
+	_lruHead = NULL;
+	_lruTail = NULL;
+	_clockHand = NULL;
+	original.flush();
 	//std::cout << original._root << "||" << &original._root << "||" << original._root << std::endl;
 	copyBinarySearchTree(original._root, _root);
 }
@@ -53,6 +111,7 @@ BinarySearchTree::BinarySearchTree(BinarySearchTree& original)
 BinarySearchTree::~BinarySearchTree()
 {
 	deleteBinarySearchTree(_root);
+	delete _filter;
 }
 
 /*****************************************************************************/
@@ -71,22 +130,30 @@ BinarySearchTree::~BinarySearchTree()
 
 bool BinarySearchTree::isEmpty() const
 {
+	applyPending();
 	return (_root==NULL);
 }
 
 /**
-* Search the binary search tree for an item
+* Search the binary search tree for an item. Buffered operations are
+* applied first, so the result reflects every insert and remove made so far
 *
 * Precondition: None
 * Postcondition: Returns true if item found, and false otherwise
 *
-* Worst-Case Time Complexity: O(h), where h is the height of the tree
+* Worst-Case Time Complexity: O(h), where h is the height of the tree, plus
+*    applyPending() if operations are buffered
 */
 
 bool BinarySearchTree::search(const DataType& item) const
 {
+	applyPending();
+
+	// definite misses never reach the tree
+	if (_filter != NULL && !_filter->mayContain(item)) {
+		return false;
+	}
 
-	// TODO
 	Node * itemLocation;
 
 	searchHelper(item, _root, itemLocation);
@@ -94,6 +161,10 @@ bool BinarySearchTree::search(const DataType& item) const
 	if(itemLocation == NULL) { //item is not found
         return false;
 	}
+
+	if (_threaded) {
+		touch(itemLocation);
+	}
 	return true; //item is found
 
 }
@@ -187,6 +258,8 @@ void BinarySearchTree::searchParent(const DataType& item, Node * subtreePtr, Nod
 
 DataType BinarySearchTree::getSuccessor(const DataType& item) const
 {
+	applyPending();
+
 	// find the item in the tree
 	Node * location = NULL;
 	searchHelper(item,_root,location);
@@ -242,6 +315,8 @@ void BinarySearchTree::getSuccessorHelper(Node * item, Node * &succLocation) con
 
 DataType BinarySearchTree::getPredecessor(const DataType& item) const
 {
+	applyPending();
+
 	// find the item in the tree
 	Node * location = NULL;
 	searchHelper(item,_root,location);
@@ -285,6 +360,126 @@ void BinarySearchTree::getPredecessorHelper(Node * item, Node * &predLocation) c
 	}
 }
 
+/**
+* Find the largest item in the binary search tree that is not greater than
+* item. Unlike getPredecessor, item does not need to be present
+*
+* Precondition: None
+* Postcondition: Returns true and sets result to the floor of item if one
+*    exists. Returns false and leaves result unchanged otherwise
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::getFloor(const DataType& item, DataType& result) const
+{
+	applyPending();
+
+	Node * floorLocation = NULL;
+	Node * ceilingLocation = NULL;
+	getBoundsHelper(item, floorLocation, ceilingLocation);
+
+	if (floorLocation == NULL) {
+		return false;
+	}
+	result = floorLocation->data;
+	return true;
+}
+
+/**
+* Find the smallest item in the binary search tree that is not less than
+* item. Unlike getSuccessor, item does not need to be present
+*
+* Precondition: None
+* Postcondition: Returns true and sets result to the ceiling of item if one
+*    exists. Returns false and leaves result unchanged otherwise
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::getCeiling(const DataType& item, DataType& result) const
+{
+	applyPending();
+
+	Node * floorLocation = NULL;
+	Node * ceilingLocation = NULL;
+	getBoundsHelper(item, floorLocation, ceilingLocation);
+
+	if (ceilingLocation == NULL) {
+		return false;
+	}
+	result = ceilingLocation->data;
+	return true;
+}
+
+/**
+* Find the item in the binary search tree closest to item. Ties are broken
+* in favour of the smaller item
+*
+* Precondition: None
+* Postcondition: Returns true and sets result to the nearest item if the tree
+*    is not empty. Returns false and leaves result unchanged otherwise
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::getNearest(const DataType& item, DataType& result) const
+{
+	applyPending();
+
+	Node * floorLocation = NULL;
+	Node * ceilingLocation = NULL;
+	getBoundsHelper(item, floorLocation, ceilingLocation);
+
+	if (floorLocation == NULL && ceilingLocation == NULL) { // empty tree
+		return false;
+	}
+
+	if (ceilingLocation == NULL) {
+		result = floorLocation->data;
+	} else if (floorLocation == NULL) {
+		result = ceilingLocation->data;
+	} else if ((long long)item - (long long)floorLocation->data
+		<= (long long)ceilingLocation->data - (long long)item) { // widened to avoid overflow
+		result = floorLocation->data;
+	} else {
+		result = ceilingLocation->data;
+	}
+	return true;
+}
+
+/**
+* Find the floor and ceiling of item in a single descent from the root
+*
+* Precondition: floorLocation and ceilingLocation point to NULL
+* Postcondition: floorLocation points to the largest item not greater than
+*    item and ceilingLocation to the smallest item not less than item. Either
+*    is NULL if no such item exists. Both point to item if it is present
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+void BinarySearchTree::getBoundsHelper(const DataType& item, Node * &floorLocation, Node * &ceilingLocation) const
+{
+	Node * current = _root;
+
+	while (current != NULL) {
+		if (current->data == item) { // exact match bounds both sides
+			floorLocation = current;
+			ceilingLocation = current;
+			return;
+		}
+
+		if (item < current->data) { // current is a candidate ceiling
+			ceilingLocation = current;
+			current = current->left;
+		} else { // current is a candidate floor
+			floorLocation = current;
+			current = current->right;
+		}
+	}
+}
+
 /**
 * Determine the maximum item in the binary search tree
 *
@@ -297,7 +492,7 @@ void BinarySearchTree::getPredecessorHelper(Node * item, Node * &predLocation) c
 
 DataType BinarySearchTree::getMaximum() const
 {
-	// TODO
+	applyPending();
 
 	Node * maxLocation = NULL;
 	getMaximumHelper(_root, maxLocation);
@@ -342,7 +537,7 @@ void BinarySearchTree::getMaximumHelper(Node * subtreeRoot, Node * &maxLocation)
 
 DataType BinarySearchTree::getMinimum() const
 {
-	// TODO
+	applyPending();
     Node * minLocation = NULL;
 	getMinimumHelper(_root, minLocation);
 
@@ -391,7 +586,7 @@ void BinarySearchTree::getMinimumHelper(Node * subtreeRoot, Node * &minLocation)
 
 int BinarySearchTree::getHeight() const
 {
-	// TODO
+	applyPending();
 	int curHeight = 0; //initializes temp variable currentHeight
 	int totHeight = 0; //initializes total height variable
 
@@ -421,24 +616,249 @@ void BinarySearchTree::getHeightHelper(Node * subtreeRoot, int * curHeight, int
 * Precondition: none
 * Postcondition: Return the number of vertices in this binary search tree
 *
-* Worst-Case Time Complexity: O(n)
+* Worst-Case Time Complexity: O(1)
 */
 
 int BinarySearchTree::getSize() const
 {
-	// TODO
-	int treeSize = 0;
-	getSizeHelper(_root, &treeSize); //uses helper function to get size
-	return treeSize;
+	applyPending();
+
+	if (_root == NULL) {
+		return 0;
+	}
+	return _root->count; //root holds the size of the whole tree
 }
 
-void BinarySearchTree::getSizeHelper(Node * subtreeRoot, int * treeSize) const
+/**
+* Select an item by its position in sorted order, using the subtree counts
+*
+* Precondition: None
+* Postcondition: Returns true and sets result to the item with exactly rank
+*    smaller items if 0 <= rank < getSize(). Returns false and leaves result
+*    unchanged otherwise
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::getByRank(int rank, DataType& result) const
 {
-    if ( subtreeRoot != 0 ) { //if BST is not empty
-      getSizeHelper( subtreeRoot->left , treeSize); //gets size of left subtree
-      *treeSize = *treeSize + 1;
-      getSizeHelper( subtreeRoot->right , treeSize ); //gets size of right subtree
-   }
+	applyPending();
+
+	if (_root == NULL || rank < 0 || rank >= _root->count) {
+		return false;
+	}
+
+	Node * current = _root;
+	while (true) {
+		int leftCount = (current->left != NULL) ? current->left->count : 0;
+		if (rank < leftCount) {
+			current = current->left;
+		} else if (rank == leftCount) {
+			result = current->data;
+			return true;
+		} else {
+			rank -= leftCount + 1;
+			current = current->right;
+		}
+	}
+}
+
+/*****************************************************************************/
+/********************** Range Aggregates *************************************/
+/*****************************************************************************/
+
+/**
+* Count and hash the items in the range [low, high]
+*
+* Precondition: count and hash are zero
+* Postcondition: count and hash hold the number and combined hash of the
+*    items x with low <= x <= high
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+void BinarySearchTree::rangeAggregate(const DataType& low, const DataType& high, int &count, HashType &hash) const
+{
+	if (high < low) {
+		return;
+	}
+
+	int upperCount = 0, lowerCount = 0;
+	SumType upperSum = 0, lowerSum = 0;
+	HashType upperHash = 0, lowerHash = 0;
+	prefixAggregateHelper(high, true, upperCount, upperSum, upperHash);
+	prefixAggregateHelper(low, false, lowerCount, lowerSum, lowerHash);
+
+	count = upperCount - lowerCount;
+	hash = upperHash - lowerHash;
+}
+
+/**
+* Count the items in the range [low, high]
+*
+* Precondition: None
+* Postcondition: Returns the number of items x with low <= x <= high
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+int BinarySearchTree::rangeCount(const DataType& low, const DataType& high) const
+{
+	applyPending();
+
+	if (high < low) {
+		return 0;
+	}
+
+	int count = 0;
+	HashType hash = 0;
+	rangeAggregate(low, high, count, hash);
+
+	return count;
+}
+
+/**
+* Sum the items in the range [low, high]
+*
+* Precondition: None
+* Postcondition: Returns the sum of the items x with low <= x <= high
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+SumType BinarySearchTree::rangeSum(const DataType& low, const DataType& high) const
+{
+	applyPending();
+
+	if (high < low) {
+		return 0;
+	}
+
+	int upperCount = 0, lowerCount = 0;
+	SumType upperSum = 0, lowerSum = 0;
+	HashType upperHash = 0, lowerHash = 0;
+	prefixAggregateHelper(high, true, upperCount, upperSum, upperHash);
+	prefixAggregateHelper(low, false, lowerCount, lowerSum, lowerHash);
+
+	return upperSum - lowerSum;
+}
+
+/**
+* Determine the minimum item in the range [low, high]
+*
+* Precondition: None
+* Postcondition: Returns true and sets result to the smallest item x with
+*    low <= x <= high if there is one. Returns false otherwise
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::rangeMinimum(const DataType& low, const DataType& high, DataType& result) const
+{
+	DataType ceiling;
+	if (!getCeiling(low, ceiling) || high < ceiling) {
+		return false;
+	}
+	result = ceiling;
+	return true;
+}
+
+/**
+* Determine the maximum item in the range [low, high]
+*
+* Precondition: None
+* Postcondition: Returns true and sets result to the largest item x with
+*    low <= x <= high if there is one. Returns false otherwise
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::rangeMaximum(const DataType& low, const DataType& high, DataType& result) const
+{
+	DataType floor;
+	if (!getFloor(high, floor) || floor < low) {
+		return false;
+	}
+	result = floor;
+	return true;
+}
+
+/**
+* Collect the items in the range [low, high]
+*
+* Precondition: None
+* Postcondition: Every item x with low <= x <= high has been appended to
+*    result in increasing order
+*
+* Worst-Case Time Complexity: O(h + k), where k is the number of items
+*    reported
+*/
+
+void BinarySearchTree::rangeScan(const DataType& low, const DataType& high, std::vector<DataType>& result) const
+{
+	applyPending();
+	rangeScanHelper(low, high, _root, result);
+}
+
+/**
+* Range scan helper function
+*
+* Precondition: subtreePtr points to a subtree of this binary search tree
+* Postcondition: Every item of the subtree in [low, high] has been appended
+*    to result in increasing order
+*
+* Worst-Case Time Complexity: O(h + k), where k is the number of items
+*    reported
+*/
+
+void BinarySearchTree::rangeScanHelper(const DataType& low, const DataType& high, Node * subtreePtr, std::vector<DataType>& result) const
+{
+	if (subtreePtr == NULL) {
+		return;
+	}
+
+	// only descend into subtrees that can hold items in range
+	if (low < subtreePtr->data) {
+		rangeScanHelper(low, high, subtreePtr->left, result);
+	}
+	if (!(subtreePtr->data < low) && !(high < subtreePtr->data)) {
+		result.push_back(subtreePtr->data);
+	}
+	if (subtreePtr->data < high) {
+		rangeScanHelper(low, high, subtreePtr->right, result);
+	}
+}
+
+/**
+* Aggregate every item below a bound using the subtree aggregates
+*
+* Precondition: count, sum and hash are zero
+* Postcondition: count, sum and hash hold the number, sum and combined hash
+*    of the items less than bound (or equal to it when inclusive is true)
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+void BinarySearchTree::prefixAggregateHelper(const DataType& bound, bool inclusive, int &count, SumType &sum, HashType &hash) const
+{
+	Node * current = _root;
+
+	while (current != NULL) {
+		if (current->data < bound || (inclusive && current->data == bound)) {
+			// current and its whole left subtree are below the bound
+			count += 1;
+			sum += current->data;
+			hash += hashItem(current->data);
+			if (current->left != NULL) {
+				count += current->left->count;
+				sum += current->left->sum;
+				hash += current->left->hash;
+			}
+			current = current->right;
+		} else {
+			current = current->left;
+		}
+	}
 }
 /*****************************************************************************/
 /********************** Traversals *******************************************/
@@ -456,7 +876,7 @@ void BinarySearchTree::getSizeHelper(Node * subtreeRoot, int * treeSize) const
 
 void BinarySearchTree::inorder(std::ostream& out) const
 {
-	// TODO
+	applyPending();
     inorderHelper(out, _root);
     out << std::endl;
 }
@@ -494,7 +914,7 @@ void BinarySearchTree::inorderHelper(std::ostream& out, Node * subtreePtr) const
 
 void BinarySearchTree::preorder(std::ostream& out) const
 {
-	// TODO
+	applyPending();
 	preorderHelper( out, _root );
 	out << std::endl;
 }
@@ -532,7 +952,7 @@ void BinarySearchTree::preorderHelper(std::ostream& out, Node * subtreePtr) cons
 
 void BinarySearchTree::postorder(std::ostream& out) const
 {
-	// TODO
+	applyPending();
 	postorderHelper( out, _root );
 	out << std::endl;
 }
@@ -558,132 +978,1733 @@ void BinarySearchTree::postorderHelper(std::ostream& out, Node * subtreePtr) con
    }
 }
 
-/*****************************************************************************/
-/********************** Operations *******************************************/
-/*****************************************************************************/
-
 /**
-* Insert item into the binary search tree
+* Inorder traversal of Binary Search Tree into a sink
 *
-* Precondition: item is not present in the binary search tree
-* Postcondition: Binary search tree has been modified with the item inserted
-*    at the proper position to maintain the binary search tree property.
-*    Returns true if item is inserted into the tree and false otherwise
+* Precondition: None
+* Postcondition: Binary Search Tree has been inorder traversed and values in
+*    nodes have been written to sink in its format
 *
-* Worst-Case Time Complexity: O(h), where h is the height of the tree
+* Worst-Case Time Complexity: O(n)
 */
 
-bool BinarySearchTree::insert(const DataType& item)
+void BinarySearchTree::inorder(TraversalSink& sink) const
 {
-	// create a  new node
-	Node * newNode = new Node(item);
+	applyPending();
+	inorderHelper(sink, _root);
+	sink.endTraversal();
+}
 
-	// if we are inserting into an empty tree
-	if (_root==NULL) {
-		_root = newNode;
-		return true;
-	}
+/**
+* Inorder traversal into a sink helper function
+*
+* Precondition: subtreePtr points to a subtree of this binary search tree
+* Postcondition: subtree with root pointed to by subtreePtr has been written
+*    to sink
+*
+* Worst-Case Time Complexity: O(n)
+*/
 
-	// if the item is the root of the tree
-	if (_root->data==item) {
-		delete newNode;
-		return false;
+void BinarySearchTree::inorderHelper(TraversalSink& sink, Node * subtreePtr) const
+{
+	if (subtreePtr != NULL) {
+		inorderHelper(sink, subtreePtr->left);
+		sink.put(subtreePtr->data);
+		inorderHelper(sink, subtreePtr->right);
 	}
+}
 
-	// find the parent of the item
-	Node * parentLocation = NULL;
-	searchParent(item,_root,parentLocation);
-
-	// add the new node to the tree, if it is not already there
-	if (item < parentLocation->data) { // left child
-		if (parentLocation->left!=NULL) {
-			delete newNode;
+/**
+* Export the items of the Binary Search Tree into a compressed key set
+*
+* Precondition: None
+* Postcondition: keys has been cleared and holds every item of the tree in
+*    compressed form, ready for lookups
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+void BinarySearchTree::compress(CompressedKeySet& keys) const
+{
+	applyPending();
+
+	keys.clear();
+	compressHelper(keys, _root);
+	keys.finish();
+}
+
+/**
+* Compressed export helper function
+*
+* Precondition: subtreePtr points to a subtree of this binary search tree
+* Postcondition: The items of the subtree have been appended to keys in
+*    increasing order
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+void BinarySearchTree::compressHelper(CompressedKeySet& keys, Node * subtreePtr) const
+{
+	if (subtreePtr != NULL) {
+		compressHelper(keys, subtreePtr->left);
+		keys.append(subtreePtr->data);
+		compressHelper(keys, subtreePtr->right);
+	}
+}
+
+/**
+* Preorder traversal of Binary Search Tree into a sink
+*
+* Precondition: None
+* Postcondition: Binary Search Tree has been preorder traversed and values in
+*    nodes have been written to sink in its format
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+void BinarySearchTree::preorder(TraversalSink& sink) const
+{
+	applyPending();
+	preorderHelper(sink, _root);
+	sink.endTraversal();
+}
+
+/**
+* Preorder traversal into a sink helper function
+*
+* Precondition: subtreePtr points to a subtree of this binary search tree
+* Postcondition: subtree with root pointed to by subtreePtr has been written
+*    to sink
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+void BinarySearchTree::preorderHelper(TraversalSink& sink, Node * subtreePtr) const
+{
+	if (subtreePtr != NULL) {
+		sink.put(subtreePtr->data);
+		preorderHelper(sink, subtreePtr->left);
+		preorderHelper(sink, subtreePtr->right);
+	}
+}
+
+/**
+* Postorder traversal of Binary Search Tree into a sink
+*
+* Precondition: None
+* Postcondition: Binary Search Tree has been postorder traversed and values in
+*    nodes have been written to sink in its format
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+void BinarySearchTree::postorder(TraversalSink& sink) const
+{
+	applyPending();
+	postorderHelper(sink, _root);
+	sink.endTraversal();
+}
+
+/**
+* Postorder traversal into a sink helper function
+*
+* Precondition: subtreePtr points to a subtree of this binary search tree
+* Postcondition: subtree with root pointed to by subtreePtr has been written
+*    to sink
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+void BinarySearchTree::postorderHelper(TraversalSink& sink, Node * subtreePtr) const
+{
+	if (subtreePtr != NULL) {
+		postorderHelper(sink, subtreePtr->left);
+		postorderHelper(sink, subtreePtr->right);
+		sink.put(subtreePtr->data);
+	}
+}
+
+/*****************************************************************************/
+/********************** Operations *******************************************/
+/*****************************************************************************/
+
+/**
+* Insert item into the binary search tree
+*
+* Precondition: item is not present in the binary search tree
+* Postcondition: Binary search tree has been modified with the item inserted
+*    at the proper position to maintain the binary search tree property.
+*    Returns true if item is inserted into the tree and false otherwise. In
+*    buffered mode the insertion is queued and true is returned
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::insert(const DataType& item)
+{
+	// in buffered mode only record the operation
+	if (_buffered) {
+		_pending.push_back(std::make_pair(item, true));
+		if ((int)_pending.size() >= _bufferLimit) {
+			flush();
+		}
+		return true;
+	}
+
+	if (insertNode(item) == NULL) {
+		return false;
+	}
+
+	enforceCapacity();
+	return true;
+}
+
+/**
+* Insert a new node holding item into the binary search tree
+*
+* Precondition: None
+* Postcondition: If item was not present a node holding it has been linked
+*    into the tree and is returned. Otherwise NULL is returned
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+BinarySearchTree::Node * BinarySearchTree::insertNode(const DataType& item)
+{
+	// create a  new node
+	Node * newNode = createNode(item);
+
+	// if we are inserting into an empty tree
+	if (_root==NULL) {
+		_root = newNode;
+		refreshNode(newNode);
+		if (_filter != NULL) {
+			_filter->add(item);
+		}
+		if (_threaded) {
+			linkNode(newNode);
+		}
+		return newNode;
+	}
+
+	// if the item is the root of the tree
+	if (_root->data==item) {
+		freeNode(newNode);
+		return NULL;
+	}
+
+	// find the parent of the item
+	Node * parentLocation = NULL;
+	searchParent(item,_root,parentLocation);
+
+	// add the new node to the tree, if it is not already there
+	if (item < parentLocation->data) { // left child
+		if (parentLocation->left!=NULL) {
+			freeNode(newNode);
+			return NULL;
+		}
+		parentLocation->left = newNode;
+	} else { // right child
+		if (parentLocation->right!=NULL) {
+			freeNode(newNode);
+			return NULL;
+		}
+		parentLocation->right = newNode;
+	}
+
+	// set the parent of the new node
+	newNode->parent = parentLocation;
+	refreshPath(newNode);
+
+	if (_filter != NULL) {
+		_filter->add(item);
+	}
+	if (_threaded) {
+		linkNode(newNode);
+	}
+
+	return newNode;
+}
+
+/**
+* Remove item from the binary search tree
+*
+* Precondition: none
+* Postcondition: binary search tree has been modified with  the item
+*    removed, if present. binary search tree property is maintained.
+*    returns true if insertion is successful and false otherwise. In
+*    buffered mode the removal is queued and true is returned
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::remove(const DataType& item)
+{
+	// in buffered mode only record the operation
+	if (_buffered) {
+		_pending.push_back(std::make_pair(item, false));
+		if ((int)_pending.size() >= _bufferLimit) {
+			flush();
+		}
+		return true;
+	}
+
+	// find the item in the binary search tree
+	Node * itemLocation = NULL;
+	searchHelper(item,_root,itemLocation);
+
+	// determine the item is in the binary search tree
+	if (itemLocation==NULL) {
+		return false;
+	}
+
+	removeNode(itemLocation);
+
+	return true;
+}
+
+/**
+* Remove a node from the binary search tree
+*
+* Precondition: itemLocation points to a node of this binary search tree
+* Postcondition: the item held by itemLocation has been removed and the
+*    binary search tree property is maintained. When the node has two
+*    children its inorder successor's node is the one that is freed
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+void BinarySearchTree::removeNode(Node * itemLocation) const
+{
+	if (_filter != NULL) {
+		_filter->remove(itemLocation->data);
+	}
+	if (_threaded) {
+		unlinkNode(itemLocation);
+	}
+
+	// get the parent of the item to be deleted
+	Node * itemParent = itemLocation->parent;
+
+	// The node containing item has 2 children
+	if (itemLocation->left != NULL && itemLocation->right!=NULL) {
+		// Find the inorder successor node of item
+		Node * itemSuccessor = NULL;
+		getSuccessorHelper(itemLocation, itemSuccessor);
+
+		// copy the data
+		itemLocation->data = itemSuccessor->data;
+		if (_intervals) {
+			asInterval(itemLocation)->end = asInterval(itemSuccessor)->end;
+		}
+
+		// the successor's item now lives in itemLocation, and so does its
+		// place in the eviction list
+		if (_threaded) {
+			replaceLinked(itemSuccessor, itemLocation);
+		}
+
+		// redirect the itemLocation pointer to the successor
+		// since that is now what will be deleted
+		itemParent = itemSuccessor->parent;
+		itemLocation = itemSuccessor;
+
+		itemLocation->data = DataType();
+	}
+
+	// We now know that the item being deleted has 0 or 1 children
+
+	// determine which subtree, if any, has children
+	Node * itemSubtree = itemLocation->left;
+	if (itemSubtree == NULL) {
+		itemSubtree = itemLocation->right;
+	}
+
+	if (itemParent == NULL) { // root being deleted
+		_root = itemSubtree;
+		if (_root!=NULL) {
+			_root->parent=NULL;
+		}
+	} else if (itemParent->left == itemLocation) {
+		itemParent->left = itemSubtree;
+	} else {
+		itemParent->right = itemSubtree;
+	}
+
+	if (itemSubtree!=NULL) {
+		itemSubtree->parent = itemParent;
+	}
+
+	refreshPath(itemParent);
+
+	// free the memory for this item
+	freeNode(itemLocation);
+}
+
+/**
+* Recompute the subtree aggregates of a node from its children
+*
+* Precondition: subtreePtr points to a node whose children hold up to date
+*    aggregates
+* Postcondition: The count, sum and hash of subtreePtr are up to date, and
+*    so is its maximum interval end in an interval tree
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::refreshNode(Node * subtreePtr) const
+{
+	subtreePtr->count = 1;
+	subtreePtr->sum = subtreePtr->data;
+	subtreePtr->hash = hashItem(subtreePtr->data);
+
+	if (subtreePtr->left != NULL) {
+		subtreePtr->count += subtreePtr->left->count;
+		subtreePtr->sum += subtreePtr->left->sum;
+		subtreePtr->hash += subtreePtr->left->hash;
+	}
+	if (subtreePtr->right != NULL) {
+		subtreePtr->count += subtreePtr->right->count;
+		subtreePtr->sum += subtreePtr->right->sum;
+		subtreePtr->hash += subtreePtr->right->hash;
+	}
+
+	if (_intervals) {
+		IntervalNode * intervalPtr = asInterval(subtreePtr);
+		intervalPtr->maxEnd = intervalPtr->end;
+		if (subtreePtr->left != NULL && intervalPtr->maxEnd < asInterval(subtreePtr->left)->maxEnd) {
+			intervalPtr->maxEnd = asInterval(subtreePtr->left)->maxEnd;
+		}
+		if (subtreePtr->right != NULL && intervalPtr->maxEnd < asInterval(subtreePtr->right)->maxEnd) {
+			intervalPtr->maxEnd = asInterval(subtreePtr->right)->maxEnd;
+		}
+	}
+}
+
+/**
+* Recompute the subtree aggregates from a node up to the root
+*
+* Precondition: subtreePtr is NULL or points to a node of this tree whose
+*    children hold up to date aggregates
+* Postcondition: Every node from subtreePtr to the root is up to date
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+void BinarySearchTree::refreshPath(Node * subtreePtr) const
+{
+	while (subtreePtr != NULL) {
+		refreshNode(subtreePtr);
+		subtreePtr = subtreePtr->parent;
+	}
+}
+
+/**
+* Allocate a node in the layout of this tree. Only interval trees pay for
+* the interval fields, and only LRU and CLOCK bounded trees for the
+* eviction list links
+*
+* Precondition: None
+* Postcondition: Returns a new unlinked node holding item
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+BinarySearchTree::Node * BinarySearchTree::createNode(const DataType& item) const
+{
+	if (_intervals && _threaded) {
+		return new LinkedIntervalNode(item);
+	}
+	if (_intervals) {
+		return new IntervalNode(item);
+	}
+	if (_threaded) {
+		return new LinkedNode(item);
+	}
+	return new Node(item);
+}
+
+/**
+* Free a node allocated by createNode
+*
+* Precondition: subtreePtr was allocated by this tree and is unlinked
+* Postcondition: The memory of subtreePtr is freed
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::freeNode(Node * subtreePtr) const
+{
+	freeNode(subtreePtr, _threaded);
+}
+
+/**
+* Free a node allocated with or without the eviction list links
+*
+* Precondition: subtreePtr is unlinked and was allocated by this tree while
+*    its eviction list was threaded, or not, as threaded says
+* Postcondition: The memory of subtreePtr is freed
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::freeNode(Node * subtreePtr, bool threaded) const
+{
+	if (_intervals && threaded) {
+		delete static_cast<LinkedIntervalNode *>(subtreePtr);
+	} else if (_intervals) {
+		delete asInterval(subtreePtr);
+	} else if (threaded) {
+		delete static_cast<LinkedNode *>(subtreePtr);
+	} else {
+		delete subtreePtr;
+	}
+}
+
+/**
+* Determine the memory used by one node of this tree
+*
+* Precondition: None
+* Postcondition: Returns the size of a node in the layout of this tree,
+*    with or without the eviction list links as threaded says
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+long long BinarySearchTree::getNodeBytes(bool threaded) const
+{
+	if (_intervals && threaded) {
+		return (long long)sizeof(LinkedIntervalNode);
+	}
+	if (_intervals) {
+		return (long long)sizeof(IntervalNode);
+	}
+	if (threaded) {
+		return (long long)sizeof(LinkedNode);
+	}
+	return (long long)sizeof(Node);
+}
+
+/**
+* Reallocate the nodes of a subtree in the current layout of this tree
+*
+* Precondition: subtreePtr points to a subtree of this binary search tree
+*    allocated while its eviction list was threaded, or not, as wasThreaded
+*    says. No node of the subtree is on the eviction list
+* Postcondition: Returns the root of an equal subtree in the current layout,
+*    whose parent link points to parent. The old nodes are freed
+*
+* Worst-Case Time Complexity: O(s), where s is the size of the subtree
+*/
+
+BinarySearchTree::Node * BinarySearchTree::relayoutHelper(Node * subtreePtr, Node * parent, bool wasThreaded)
+{
+	if (subtreePtr == NULL) {
+		return NULL;
+	}
+
+	Node * moved = createNode(subtreePtr->data);
+	if (_intervals) {
+		asInterval(moved)->end = asInterval(subtreePtr)->end;
+	}
+	moved->parent = parent;
+	moved->left = relayoutHelper(subtreePtr->left, moved, wasThreaded);
+	moved->right = relayoutHelper(subtreePtr->right, moved, wasThreaded);
+	refreshNode(moved);
+
+	freeNode(subtreePtr, wasThreaded);
+
+	return moved;
+}
+
+/**
+* Load sorted items into an empty binary search tree as a balanced tree
+*
+* Precondition: The tree is empty. keys is strictly increasing
+* Postcondition: Returns true and the tree holds keys with height
+*    O(log n) if the preconditions hold. Returns false and leaves the tree
+*    unchanged otherwise
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+bool BinarySearchTree::loadSorted(const std::vector<DataType>& keys)
+{
+	flush();
+
+	if (_root != NULL) {
+		return false;
+	}
+
+	for (size_t i = 1; i < keys.size(); i++) {
+		if (!(keys[i - 1] < keys[i])) {
 			return false;
 		}
-		parentLocation->left = newNode;
-	} else { // right child
-		if (parentLocation->right!=NULL) {
-			delete newNode;
-			return false;
+	}
+
+	_root = buildBalanced(keys, 0, (int)keys.size(), NULL);
+	enforceCapacity();
+
+	return true;
+}
+
+/*****************************************************************************/
+/********************** Replica Comparison ***********************************/
+/*****************************************************************************/
+
+/**
+* Determine the hash of the whole key set. Every node holds the sum of the
+* mixed hashes of the items in its subtree, so two trees holding the same
+* items have the same hash whatever their shape
+*
+* Precondition: None
+* Postcondition: Returns the hash of the items in the tree (0 when empty)
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+HashType BinarySearchTree::getHash() const
+{
+	applyPending();
+
+	if (_root == NULL) {
+		return 0;
+	}
+	return _root->hash;
+}
+
+/**
+* Determine the hash of the items in the range [low, high]. Replicas can
+* exchange range hashes to find where they differ
+*
+* Precondition: None
+* Postcondition: Returns the hash of the items x with low <= x <= high
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+HashType BinarySearchTree::rangeHash(const DataType& low, const DataType& high) const
+{
+	applyPending();
+
+	int count = 0;
+	HashType hash = 0;
+	rangeAggregate(low, high, count, hash);
+
+	return hash;
+}
+
+/**
+* Find the items that must change for this tree to match other. Key ranges
+* are bisected, and only ranges whose counts or hashes differ are examined
+* further, so nearly identical trees are compared without a traversal
+*
+* Precondition: None
+* Postcondition: toAdd holds the items of other missing from this tree and
+*    toRemove the items of this tree missing from other, both in increasing
+*    order
+*
+* Worst-Case Time Complexity: O(d * b * h), where d is the number of
+*    differing items and b the number of bits in DataType; O(n) at most
+*/
+
+void BinarySearchTree::diff(const BinarySearchTree& other, std::vector<DataType>& toAdd, std::vector<DataType>& toRemove) const
+{
+	applyPending();
+	other.applyPending();
+
+	if (isEmpty() && other.isEmpty()) {
+		return;
+	}
+
+	// start from a range covering both key sets
+	DataType low, high;
+	if (isEmpty()) {
+		low = other.getMinimum();
+		high = other.getMaximum();
+	} else if (other.isEmpty()) {
+		low = getMinimum();
+		high = getMaximum();
+	} else {
+		low = (getMinimum() < other.getMinimum()) ? getMinimum() : other.getMinimum();
+		high = (other.getMaximum() < getMaximum()) ? getMaximum() : other.getMaximum();
+	}
+
+	diffHelper(other, low, high, toAdd, toRemove);
+}
+
+/**
+* Compare this tree and other over the range [low, high]
+*
+* Precondition: low <= high
+* Postcondition: The differing items in the range have been appended to
+*    toAdd and toRemove in increasing order
+*
+* Worst-Case Time Complexity: O(d * b * h) for d differing items in range
+*/
+
+void BinarySearchTree::diffHelper(const BinarySearchTree& other, const DataType& low, const DataType& high,
+	std::vector<DataType>& toAdd, std::vector<DataType>& toRemove) const
+{
+	int count = 0, otherCount = 0;
+	HashType hash = 0, otherHash = 0;
+	rangeAggregate(low, high, count, hash);
+	other.rangeAggregate(low, high, otherCount, otherHash);
+
+	if (count == otherCount && hash == otherHash) { // range matches
+		return;
+	}
+
+	// small ranges are compared item by item
+	if (count + otherCount <= DIFF_SCAN_LIMIT || low == high) {
+		std::vector<DataType> items, otherItems;
+		rangeScanHelper(low, high, _root, items);
+		other.rangeScanHelper(low, high, other._root, otherItems);
+
+		size_t i = 0, j = 0;
+		while (i < items.size() || j < otherItems.size()) {
+			if (j == otherItems.size() || (i < items.size() && items[i] < otherItems[j])) {
+				toRemove.push_back(items[i++]);
+			} else if (i == items.size() || otherItems[j] < items[i]) {
+				toAdd.push_back(otherItems[j++]);
+			} else {
+				i++;
+				j++;
+			}
+		}
+		return;
+	}
+
+	// split the range in half without overflowing
+	DataType middle = (DataType)(low + ((long long)high - (long long)low) / 2);
+	diffHelper(other, low, middle, toAdd, toRemove);
+	diffHelper(other, middle + 1, high, toAdd, toRemove);
+}
+
+/*****************************************************************************/
+/********************** Bulk Range Operations ********************************/
+/*****************************************************************************/
+
+/**
+* Remove every item in the range [low, high]. The range is split off with a
+* constant number of pointer splices per level and freed in one pass,
+* rather than removing the items one at a time
+*
+* Precondition: None
+* Postcondition: No item x with low <= x <= high is in the tree. Returns the
+*    number of items removed. Buffered operations are applied first
+*
+* Worst-Case Time Complexity: O(h + k), where k is the number of items
+*    removed
+*/
+
+int BinarySearchTree::eraseRange(const DataType& low, const DataType& high)
+{
+	applyPending();
+
+	if (high < low || _root == NULL) {
+		return 0;
+	}
+
+	Node * lower = NULL;
+	Node * rest = NULL;
+	Node * middle = NULL;
+	Node * upper = NULL;
+	splitHelper(_root, low, false, lower, rest);
+	splitHelper(rest, high, true, middle, upper);
+	_root = joinHelper(lower, upper);
+
+	int erased = (middle != NULL) ? middle->count : 0;
+	eraseHelper(middle);
+
+	return erased;
+}
+
+/**
+* Move every item in the range [low, high] into another binary search tree.
+* The nodes themselves change owner, so no item is copied unless the trees
+* use different node layouts (an interval tree and a plain tree). The items
+* moved must all be less than, or all be greater than, the items of target
+*
+* Precondition: target is not this tree
+* Postcondition: Returns true and target holds the items of the range,
+*    which are no longer in this tree. Returns false and leaves both trees
+*    unchanged if target is this tree or the range interleaves with target.
+*    Buffered operations of both trees are applied first
+*
+* Worst-Case Time Complexity: O(h + h'), where h' is the height of target,
+*    plus O(k) when either tree has a filter or an eviction list, or the
+*    layouts differ
+*/
+
+bool BinarySearchTree::extractRange(const DataType& low, const DataType& high, BinarySearchTree& target)
+{
+	if (&target == this) {
+		return false;
+	}
+
+	applyPending();
+	target.applyPending();
+
+	DataType first;
+	DataType last;
+	if (!rangeMinimum(low, high, first)) { // nothing to move
+		return true;
+	}
+	rangeMaximum(low, high, last);
+
+	// the moved items must sit wholly on one side of target's items
+	bool below = (target._root == NULL || last < target.getMinimum());
+	bool above = (target._root == NULL || target.getMaximum() < first);
+	if (!below && !above) {
+		return false;
+	}
+
+	Node * lower = NULL;
+	Node * rest = NULL;
+	Node * middle = NULL;
+	Node * upper = NULL;
+	splitHelper(_root, low, false, lower, rest);
+	splitHelper(rest, high, true, middle, upper);
+	_root = joinHelper(lower, upper);
+
+	if (_filter != NULL || _threaded || target._filter != NULL || target._threaded
+		|| _intervals != target._intervals) {
+		middle = transferHelper(target, middle, NULL);
+	}
+
+	if (below) {
+		target._root = target.joinHelper(middle, target._root);
+	} else {
+		target._root = target.joinHelper(target._root, middle);
+	}
+
+	target.enforceCapacity();
+
+	return true;
+}
+
+/**
+* Split a subtree around a bound. Only the nodes on the search path for
+* bound are relinked
+*
+* Precondition: subtreePtr points to a subtree whose parent no longer
+*    refers to it
+* Postcondition: lower holds the items of the subtree less than bound (not
+*    greater than bound when inclusive) and upper holds the rest. Both are
+*    detached subtrees with up to date aggregates
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the subtree
+*/
+
+void BinarySearchTree::splitHelper(Node * subtreePtr, const DataType& bound, bool inclusive,
+	Node * &lower, Node * &upper)
+{
+	if (subtreePtr == NULL) {
+		lower = NULL;
+		upper = NULL;
+		return;
+	}
+
+	Node * left = NULL;
+	Node * right = NULL;
+	bool isLower = inclusive ? !(bound < subtreePtr->data) : (subtreePtr->data < bound);
+
+	if (isLower) { // the node and its left subtree belong to lower
+		splitHelper(subtreePtr->right, bound, inclusive, left, right);
+		subtreePtr->right = left;
+		if (left != NULL) {
+			left->parent = subtreePtr;
+		}
+		lower = subtreePtr;
+		upper = right;
+	} else {       // the node and its right subtree belong to upper
+		splitHelper(subtreePtr->left, bound, inclusive, left, right);
+		subtreePtr->left = right;
+		if (right != NULL) {
+			right->parent = subtreePtr;
+		}
+		lower = left;
+		upper = subtreePtr;
+	}
+
+	subtreePtr->parent = NULL;
+	refreshNode(subtreePtr);
+}
+
+/**
+* Join two subtrees. The maximum of lower is lifted to become the new root,
+* so the result is at most one level taller than the taller subtree
+*
+* Precondition: lower and upper are detached subtrees, and every item of
+*    lower is less than every item of upper
+* Postcondition: Returns the root of a detached subtree holding the items of
+*    both
+*
+* Worst-Case Time Complexity: O(h), where h is the height of lower
+*/
+
+BinarySearchTree::Node * BinarySearchTree::joinHelper(Node * lower, Node * upper)
+{
+	if (lower == NULL) {
+		return upper;
+	}
+	if (upper == NULL) {
+		return lower;
+	}
+
+	Node * top = NULL;
+	getMaximumHelper(lower, top);
+
+	if (top != lower) {
+		// splice the maximum out of lower; lower is detached, so refreshing
+		// stops at its root
+		Node * topParent = top->parent;
+		topParent->right = top->left;
+		if (top->left != NULL) {
+			top->left->parent = topParent;
+		}
+		refreshPath(topParent);
+
+		top->left = lower;
+		lower->parent = top;
+	}
+
+	top->right = upper;
+	upper->parent = top;
+	top->parent = NULL;
+	refreshNode(top);
+
+	return top;
+}
+
+/**
+* Free a detached subtree
+*
+* Precondition: subtreePtr points to a detached subtree whose items were in
+*    this binary search tree
+* Postcondition: Every node of the subtree has been freed, and its items
+*    taken out of the filter and the eviction list
+*
+* Worst-Case Time Complexity: O(s), where s is the size of the subtree
+*/
+
+void BinarySearchTree::eraseHelper(Node * subtreePtr)
+{
+	if (subtreePtr != NULL) {
+		eraseHelper(subtreePtr->left);
+		eraseHelper(subtreePtr->right);
+
+		if (_filter != NULL) {
+			_filter->remove(subtreePtr->data);
+		}
+		if (_threaded) {
+			unlinkNode(subtreePtr);
+		}
+
+		freeNode(subtreePtr);
+	}
+}
+
+/**
+* Hand a detached subtree from this binary search tree to target. Filter and
+* eviction list entries move with the items, and nodes are reallocated in
+* target's layout if it differs from this tree's
+*
+* Precondition: subtreePtr points to a detached subtree whose items were in
+*    this binary search tree
+* Postcondition: Returns the root of a subtree in target's layout, whose
+*    parent link points to parent, holding the items of the subtree. They
+*    are in target's filter and eviction list, if enabled, and no longer in
+*    this tree's
+*
+* Worst-Case Time Complexity: O(s), where s is the size of the subtree
+*/
+
+BinarySearchTree::Node * BinarySearchTree::transferHelper(BinarySearchTree& target, Node * subtreePtr, Node * parent)
+{
+	if (subtreePtr == NULL) {
+		return NULL;
+	}
+
+	if (_filter != NULL) {
+		_filter->remove(subtreePtr->data);
+	}
+	if (_threaded) {
+		unlinkNode(subtreePtr);
+	}
+
+	Node * left = subtreePtr->left;
+	Node * right = subtreePtr->right;
+	Node * moved = subtreePtr;
+
+	if (_intervals != target._intervals || _threaded != target._threaded) {
+		moved = target.createNode(subtreePtr->data);
+		if (_intervals && target._intervals) {
+			asInterval(moved)->end = asInterval(subtreePtr)->end;
+		}
+		freeNode(subtreePtr);
+	}
+	moved->parent = parent;
+
+	if (target._filter != NULL) {
+		target._filter->add(moved->data);
+	}
+	if (target._threaded) {
+		target.linkNode(moved);
+	}
+
+	moved->left = transferHelper(target, left, moved);
+	moved->right = transferHelper(target, right, moved);
+	target.refreshNode(moved);
+
+	return moved;
+}
+
+/*****************************************************************************/
+/********************** Negative Lookup Filter *******************************/
+/*****************************************************************************/
+
+/**
+* Put a counting Bloom filter in front of search. The filter is kept in sync
+* with every insert and remove, so search answers definite misses without
+* descending the tree
+*
+* Precondition: expectedItems is positive. 0 < falsePositiveRate < 1
+* Postcondition: A filter sized for expectedItems at falsePositiveRate holds
+*    every item of the tree, replacing any previous filter
+*
+* Worst-Case Time Complexity: O(n + m), where m is the size of the filter
+*/
+
+void BinarySearchTree::enableFilter(int expectedItems, double falsePositiveRate)
+{
+	flush();
+
+	delete _filter;
+	_filter = new CountingBloomFilter(expectedItems, falsePositiveRate);
+	addToFilterHelper(_root);
+}
+
+/**
+* Remove the negative lookup filter
+*
+* Precondition: None
+* Postcondition: search always descends the tree
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::disableFilter()
+{
+	delete _filter;
+	_filter = NULL;
+}
+
+/**
+* Check if a negative lookup filter is in front of search
+*
+* Precondition: None
+* Postcondition: Returns true if a filter is enabled
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+bool BinarySearchTree::isFiltered() const
+{
+	return (_filter != NULL);
+}
+
+/**
+* Add every item of a subtree to the filter
+*
+* Precondition: The filter is enabled. subtreePtr points to a subtree of
+*    this binary search tree
+* Postcondition: Every item of the subtree has been added to the filter
+*
+* Worst-Case Time Complexity: O(s), where s is the size of the subtree
+*/
+
+void BinarySearchTree::addToFilterHelper(Node * subtreePtr)
+{
+	if (subtreePtr != NULL) {
+		_filter->add(subtreePtr->data);
+		addToFilterHelper(subtreePtr->left);
+		addToFilterHelper(subtreePtr->right);
+	}
+}
+
+/*****************************************************************************/
+/********************** Capacity Bound ***************************************/
+/*****************************************************************************/
+
+/**
+* Bound the number of nodes in the tree. Whenever an insert takes the tree
+* past capacity, items are evicted according to policy. For EVICT_LRU and
+* EVICT_CLOCK every node is threaded onto an eviction list, which search
+* and access update, so choosing a victim is O(1) amortized. Only those
+* policies give nodes the list links, so the nodes are reallocated when
+* the tree starts or stops using them
+*
+* Precondition: capacity is not negative
+* Postcondition: The tree holds at most capacity items (any number when
+*    capacity is 0), evicting items now if it holds more
+*
+* Worst-Case Time Complexity: O(n) to thread the list, plus O(h) per item
+*    evicted
+*/
+
+void BinarySearchTree::setCapacity(int capacity, EvictionPolicy policy)
+{
+	flush();
+
+	_capacity = capacity;
+	_evictionPolicy = policy;
+
+	_lruHead = NULL;
+	_lruTail = NULL;
+	_clockHand = NULL;
+
+	bool wasThreaded = _threaded;
+	_threaded = (capacity > 0 && (policy == EVICT_LRU || policy == EVICT_CLOCK));
+	if (_threaded != wasThreaded) {
+		_root = relayoutHelper(_root, NULL, wasThreaded);
+	}
+	if (_threaded) {
+		threadHelper(_root);
+	}
+
+	enforceCapacity();
+}
+
+/**
+* Bound the memory used by the nodes of the tree
+*
+* Precondition: bytes is positive
+* Postcondition: The capacity is the number of nodes that fit in bytes
+*
+* Worst-Case Time Complexity: see setCapacity
+*/
+
+void BinarySearchTree::setByteBudget(long long bytes, EvictionPolicy policy)
+{
+	long long capacity = bytes / getNodeBytes(policy == EVICT_LRU || policy == EVICT_CLOCK);
+	if (capacity < 1) {
+		capacity = 1;
+	}
+	setCapacity((int)capacity, policy);
+}
+
+/**
+* Determine the capacity of the tree
+*
+* Precondition: None
+* Postcondition: Returns the maximum number of items, or 0 if unbounded
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int BinarySearchTree::getCapacity() const
+{
+	return _capacity;
+}
+
+/**
+* Register a callback for evicted items
+*
+* Precondition: listener is NULL or outlives its registration
+* Postcondition: listener is told about every item evicted from now on
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::setEvictionListener(EvictionListener * listener)
+{
+	_evictionListener = listener;
+}
+
+/**
+* Evict items until the tree is within its capacity
+*
+* Precondition: None
+* Postcondition: The tree holds at most capacity items. The listener has
+*    been told about each item evicted, after it left the tree
+*
+* Worst-Case Time Complexity: O(h) per item evicted
+*/
+
+void BinarySearchTree::enforceCapacity() const
+{
+	while (_capacity > 0 && _root != NULL && _root->count > _capacity) {
+		Node * victim = chooseVictim();
+		DataType item = victim->data;
+
+		removeNode(victim);
+
+		if (_evictionListener != NULL) {
+			_evictionListener->evicted(item);
+		}
+	}
+}
+
+/**
+* Choose the node to evict under the eviction policy
+*
+* Precondition: The tree is not empty
+* Postcondition: Returns the node holding the item to evict
+*
+* Worst-Case Time Complexity: O(h) for EVICT_MINIMUM and EVICT_MAXIMUM, O(1)
+*    for EVICT_LRU and O(1) amortized for EVICT_CLOCK
+*/
+
+BinarySearchTree::Node * BinarySearchTree::chooseVictim() const
+{
+	Node * victim = NULL;
+
+	switch (_evictionPolicy) {
+	case EVICT_MINIMUM:
+		getMinimumHelper(_root, victim);
+		break;
+	case EVICT_MAXIMUM:
+		getMaximumHelper(_root, victim);
+		break;
+	case EVICT_LRU:
+		victim = _lruTail;
+		break;
+	case EVICT_CLOCK:
+		// sweep from the oldest item, giving referenced items a second chance
+		if (_clockHand == NULL) {
+			_clockHand = _lruTail;
+		}
+		while (linksOf(_clockHand)->referenced) {
+			EvictionLinks * links = linksOf(_clockHand);
+			links->referenced = false;
+			_clockHand = (links->lruPrev != NULL) ? links->lruPrev : _lruTail;
+		}
+		victim = _clockHand;
+		break;
+	}
+
+	return victim;
+}
+
+/**
+* Link every node of a subtree into the eviction list
+*
+* Precondition: subtreePtr points to a subtree of this binary search tree
+* Postcondition: Every node of the subtree is on the eviction list
+*
+* Worst-Case Time Complexity: O(s), where s is the size of the subtree
+*/
+
+void BinarySearchTree::threadHelper(Node * subtreePtr)
+{
+	if (subtreePtr != NULL) {
+		linkNode(subtreePtr);
+		threadHelper(subtreePtr->left);
+		threadHelper(subtreePtr->right);
+	}
+}
+
+/**
+* Link a node at the most recently used end of the eviction list
+*
+* Precondition: subtreePtr is not on the eviction list
+* Postcondition: subtreePtr is the head of the eviction list
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::linkNode(Node * subtreePtr) const
+{
+	EvictionLinks * links = linksOf(subtreePtr);
+	links->lruPrev = NULL;
+	links->lruNext = _lruHead;
+	links->referenced = false;
+
+	if (_lruHead != NULL) {
+		linksOf(_lruHead)->lruPrev = subtreePtr;
+	} else {
+		_lruTail = subtreePtr;
+	}
+	_lruHead = subtreePtr;
+}
+
+/**
+* Unlink a node from the eviction list
+*
+* Precondition: subtreePtr is on the eviction list
+* Postcondition: subtreePtr is off the eviction list and the clock hand no
+*    longer points to it
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::unlinkNode(Node * subtreePtr) const
+{
+	EvictionLinks * links = linksOf(subtreePtr);
+
+	if (_clockHand == subtreePtr) {
+		_clockHand = links->lruPrev;
+	}
+
+	if (links->lruPrev != NULL) {
+		linksOf(links->lruPrev)->lruNext = links->lruNext;
+	} else {
+		_lruHead = links->lruNext;
+	}
+	if (links->lruNext != NULL) {
+		linksOf(links->lruNext)->lruPrev = links->lruPrev;
+	} else {
+		_lruTail = links->lruPrev;
+	}
+
+	links->lruPrev = NULL;
+	links->lruNext = NULL;
+}
+
+/**
+* Put a node in another node's place on the eviction list
+*
+* Precondition: original is on the eviction list and replacement is not
+* Postcondition: replacement has original's position and reference bit, and
+*    original is off the list
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::replaceLinked(Node * original, Node * replacement) const
+{
+	EvictionLinks * originalLinks = linksOf(original);
+	EvictionLinks * replacementLinks = linksOf(replacement);
+	*replacementLinks = *originalLinks;
+
+	if (originalLinks->lruPrev != NULL) {
+		linksOf(originalLinks->lruPrev)->lruNext = replacement;
+	} else {
+		_lruHead = replacement;
+	}
+	if (originalLinks->lruNext != NULL) {
+		linksOf(originalLinks->lruNext)->lruPrev = replacement;
+	} else {
+		_lruTail = replacement;
+	}
+	if (_clockHand == original) {
+		_clockHand = replacement;
+	}
+
+	originalLinks->lruPrev = NULL;
+	originalLinks->lruNext = NULL;
+}
+
+/**
+* Record an access to a node for the eviction policy
+*
+* Precondition: subtreePtr is on the eviction list
+* Postcondition: Under EVICT_LRU subtreePtr is the most recently used node.
+*    Under EVICT_CLOCK its reference bit is set
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::touch(Node * subtreePtr) const
+{
+	if (_evictionPolicy == EVICT_CLOCK) {
+		linksOf(subtreePtr)->referenced = true;
+	} else if (_lruHead != subtreePtr) {
+		unlinkNode(subtreePtr);
+		linkNode(subtreePtr);
+	}
+}
+
+/*****************************************************************************/
+/********************** Buffered Mode ****************************************/
+/*****************************************************************************/
+
+/**
+* Enable or disable buffered mode. In buffered mode insert and remove are
+* appended to a log and merged into the tree in batches. Reads apply the
+* log first, so buffering pays off for runs of writes
+*
+* Precondition: None
+* Postcondition: Buffered mode is set. Disabling it applies any buffered
+*    operations to the tree
+*
+* Worst-Case Time Complexity: O(1) to enable; see flush() to disable
+*/
+
+void BinarySearchTree::setBuffered(bool enabled)
+{
+	if (!enabled) {
+		flush();
+	}
+	_buffered = enabled;
+}
+
+/**
+* Check if the Binary Search Tree is in buffered mode
+*
+* Precondition: None
+* Postcondition: Returns true if buffered mode is enabled
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+bool BinarySearchTree::isBuffered() const
+{
+	return _buffered;
+}
+
+/**
+* Set the number of buffered operations that triggers a flush
+*
+* Precondition: limit is positive
+* Postcondition: The buffer is flushed whenever it holds limit operations
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::setBufferLimit(int limit)
+{
+	_bufferLimit = limit;
+}
+
+/**
+* Determine the number of operations waiting in the buffer
+*
+* Precondition: None
+* Postcondition: Returns the number of buffered operations, counting repeated
+*    operations on one key
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int BinarySearchTree::getPendingCount() const
+{
+	return (int)_pending.size();
+}
+
+/**
+* Apply all buffered operations to the tree
+*
+* Precondition: None
+* Postcondition: The buffer is empty and the tree holds the result of every
+*    buffered operation
+*
+* Worst-Case Time Complexity: see applyPending()
+*/
+
+void BinarySearchTree::flush()
+{
+	applyPending();
+}
+
+/**
+* Apply all buffered operations to the tree in a single merge pass. The log
+* is sorted by key and reduced to the last operation on each key, then each
+* subtree is visited at most once, with the log partitioned around its
+* root, and runs of inserts that fall off the tree are attached as balanced
+* subtrees. Reads call this first; the buffer is part of the logical
+* contents of the tree, so applying it does not change the observable
+* state, and the root and the buffer are mutable for this
+*
+* Precondition: None
+* Postcondition: The buffer is empty
+*
+* Worst-Case Time Complexity: O(m log m + min(n, m * h)), where m is the
+*    number of buffered operations
+*/
+
+void BinarySearchTree::applyPending() const
+{
+	if (_pending.empty()) {
+		return;
+	}
+
+	// take the log, so operations buffered while it is applied start a new one
+	std::vector<std::pair<DataType, bool> > operations;
+	operations.swap(_pending);
+
+	// the last operation on each key wins
+	std::stable_sort(operations.begin(), operations.end(), pendingKeyLess);
+	int kept = 0;
+	for (int i = 0; i < (int)operations.size(); i++) {
+		if (kept > 0 && operations[kept - 1].first == operations[i].first) {
+			operations[kept - 1].second = operations[i].second;
+		} else {
+			operations[kept++] = operations[i];
+		}
+	}
+
+	applyBatchHelper(_root, NULL, operations, 0, kept);
+
+	// hand the storage back for the next batch
+	operations.clear();
+	if (_pending.empty()) {
+		_pending.swap(operations);
+	}
+
+	enforceCapacity();
+}
+
+/**
+* Merge a sorted run of buffered operations into a subtree
+*
+* Precondition: subtreePtr is a subtree of this binary search tree whose
+*    parent is parent. operations[first, last) is sorted by key and holds
+*    only keys that belong in this subtree
+* Postcondition: Every operation in the run has been applied to the subtree
+*
+* Worst-Case Time Complexity: O(m + min(s, m * h)), where m = last - first
+*    and s is the size of the subtree
+*/
+
+void BinarySearchTree::applyBatchHelper(Node * &subtreePtr, Node * parent,
+	const std::vector<std::pair<DataType, bool> >& operations, int first, int last) const
+{
+	if (first >= last) {
+		return;
+	}
+
+	// the run fell off the tree, so its inserts form a new subtree
+	if (subtreePtr == NULL) {
+		std::vector<DataType> keys;
+		for (int i = first; i < last; i++) {
+			if (operations[i].second) {
+				keys.push_back(operations[i].first);
+			}
 		}
-		parentLocation->right = newNode;
+		subtreePtr = buildBalanced(keys, 0, (int)keys.size(), parent);
+		return;
 	}
 
-	// set the parent of the new node
-	newNode->parent = parentLocation;
+	// partition the run around this node with a binary search
+	int split = first;
+	int end = last;
+	while (split < end) {
+		int middle = split + (end - split) / 2;
+		if (operations[middle].first < subtreePtr->data) {
+			split = middle + 1;
+		} else {
+			end = middle;
+		}
+	}
+	bool matched = (split < last && operations[split].first == subtreePtr->data);
 
-	return true;
+	applyBatchHelper(subtreePtr->left, subtreePtr, operations, first, split);
+	applyBatchHelper(subtreePtr->right, subtreePtr, operations, matched ? split + 1 : split, last);
+	refreshNode(subtreePtr);
+
+	// removing this node last keeps the subtrees above valid while recursing
+	if (matched && !operations[split].second) {
+		removeNode(subtreePtr);
+	}
 }
 
 /**
-* Remove item from the binary search tree
+* Build a balanced subtree from sorted keys
 *
-* Precondition: none
-* Postcondition: binary search tree has been modified with  the item
-*    removed, if present. binary search tree property is maintained.
-*    returns true if insertion is successful and false otherwise.
+* Precondition: keys[first, last) is sorted and holds no duplicates
+* Postcondition: Returns the root of a balanced subtree holding the keys,
+*    whose parent link points to parent (NULL for an empty range)
 *
-* Worst-Case Time Complexity: O(h), where h is the height of the tree
+* Worst-Case Time Complexity: O(last - first)
 */
 
-bool BinarySearchTree::remove(const DataType& item)
+BinarySearchTree::Node * BinarySearchTree::buildBalanced(const std::vector<DataType>& keys,
+	int first, int last, Node * parent) const
 {
-	// find the item in the binary search tree
-	Node * itemLocation = NULL;
-	searchHelper(item,_root,itemLocation);
+	if (first >= last) {
+		return NULL;
+	}
 
-	// determine the item is in the binary search tree
-	if (itemLocation==NULL) {
-		return false;
+	int middle = first + (last - first) / 2;
+	Node * subtreeRoot = createNode(keys[middle]);
+	subtreeRoot->parent = parent;
+	if (_filter != NULL) {
+		_filter->add(keys[middle]);
+	}
+	if (_threaded) {
+		linkNode(subtreeRoot);
 	}
+	subtreeRoot->left = buildBalanced(keys, first, middle, subtreeRoot);
+	subtreeRoot->right = buildBalanced(keys, middle + 1, last, subtreeRoot);
+	refreshNode(subtreeRoot);
 
-	// get the parent of the item to be deleted
-	Node * itemParent = itemLocation->parent;
+	return subtreeRoot;
+}
 
-	// The node containing item has 2 children
-	if (itemLocation->left != NULL && itemLocation->right!=NULL) {
-		// Find the inorder successor node of item
-		Node * itemSuccessor = NULL;
-		getSuccessorHelper(itemLocation, itemSuccessor);
+/*****************************************************************************/
+/********************** Self-Adjusting Mode **********************************/
+/*****************************************************************************/
 
-		// copy the data
-		itemLocation->data = itemSuccessor->data;
+/**
+* Enable or disable self-adjusting (semi-splay) mode
+*
+* Precondition: None
+* Postcondition: When enabled, access() lifts items it finds deep in the tree
+*    so that frequently accessed items stay near the top of the tree
+*
+* Worst-Case Time Complexity: O(1)
+*/
 
-		// redirect the itemLocation pointer to the successor
-		// since that is now what will be deleted
-		itemParent = itemSuccessor->parent;
-		itemLocation = itemSuccessor;
+void BinarySearchTree::setSelfAdjusting(bool enabled)
+{
+	_selfAdjusting = enabled;
+}
 
-		itemLocation->data = DataType();
+/**
+* Check if the Binary Search Tree is in self-adjusting mode
+*
+* Precondition: None
+* Postcondition: Returns true if self-adjusting mode is enabled
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+bool BinarySearchTree::isSelfAdjusting() const
+{
+	return _selfAdjusting;
+}
+
+/**
+* Search the binary search tree for an item, restructuring the tree in
+* self-adjusting mode. When the last node visited (the item itself, or the
+* node where the search fell off the tree) lies more than SPLAY_DEPTH_SLACK
+* levels below the height of a balanced tree of the same size, it is
+* semi-splayed to about half its depth. Hot items settle near the top after
+* a few lookups, while items already near the top are read without writing
+* to the tree. Without self-adjusting mode this behaves exactly like search.
+*
+* Precondition: None
+* Postcondition: Returns true if item found, and false otherwise
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool BinarySearchTree::access(const DataType& item)
+{
+	flush();
+
+	// definite misses leave the tree as it is
+	if (_filter != NULL && !_filter->mayContain(item)) {
+		return false;
 	}
 
-	// We now know that the item being deleted has 0 or 1 children
+	Node * current = _root;
+	Node * last = NULL;
+	int depth = 0;
+
+	while (current != NULL && !(current->data == item)) {
+		last = current;
+		depth++;
+		if (item < current->data) {
+			current = current->left;
+		} else {
+			current = current->right;
+		}
+	}
 
-	// determine which subtree, if any, has children
-	Node * itemSubtree = itemLocation->left;
-	if (itemSubtree == NULL) {
-		itemSubtree = itemLocation->right;
+	if (_threaded && current != NULL) {
+		touch(current);
 	}
 
-	if (itemParent == NULL) { // root being deleted
-		_root = itemSubtree;
-		if (_root!=NULL) {
-			_root->parent=NULL;
+	if (_selfAdjusting && depth > SPLAY_DEPTH_SLACK) {
+		// the height of a balanced tree of this size, plus the slack
+		int threshold = SPLAY_DEPTH_SLACK;
+		for (int size = _root->count; size > 1; size >>= 1) {
+			threshold++;
+		}
+
+		if (depth > threshold) {
+			semiSplay((current != NULL) ? current : last);
 		}
-	} else if (itemParent->left == itemLocation) {
-		itemParent->left = itemSubtree;
-	} else {
-		itemParent->right = itemSubtree;
 	}
 
-	if (itemSubtree!=NULL) {
-		itemSubtree->parent = itemParent;
+	return (current != NULL);
+}
+
+/**
+* Rotate a node above its parent
+*
+* Precondition: subtreePtr points to a node of this binary search tree that
+*    has a parent
+* Postcondition: subtreePtr has taken its parent's place, the former parent is
+*    its child and the binary search tree property is maintained
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void BinarySearchTree::rotateUp(Node * subtreePtr)
+{
+	Node * parent = subtreePtr->parent;
+	Node * grandparent = parent->parent;
+
+	if (parent->left == subtreePtr) { // right rotation
+		parent->left = subtreePtr->right;
+		if (subtreePtr->right != NULL) {
+			subtreePtr->right->parent = parent;
+		}
+		subtreePtr->right = parent;
+	} else { // left rotation
+		parent->right = subtreePtr->left;
+		if (subtreePtr->left != NULL) {
+			subtreePtr->left->parent = parent;
+		}
+		subtreePtr->left = parent;
 	}
 
-	// free the memory for this item
-	delete itemLocation;
+	parent->parent = subtreePtr;
+	subtreePtr->parent = grandparent;
 
-	return true;
+	// the rotated subtree holds the same items, so subtreePtr takes over the
+	// parent's aggregates and only the parent is recomputed
+	subtreePtr->count = parent->count;
+	subtreePtr->sum = parent->sum;
+	subtreePtr->hash = parent->hash;
+	if (_intervals) {
+		asInterval(subtreePtr)->maxEnd = asInterval(parent)->maxEnd;
+	}
+	refreshNode(parent);
+
+	// hook the rotated subtree back into the tree
+	if (grandparent == NULL) {
+		_root = subtreePtr;
+	} else if (grandparent->left == parent) {
+		grandparent->left = subtreePtr;
+	} else {
+		grandparent->right = subtreePtr;
+	}
+}
+
+/**
+* Semi-splay a node towards the root. A zig-zig step rotates only the parent
+* and carries on from it, and a zig-zag step rotates the node twice, so the
+* node ends up at about half its depth with one rotation per two levels on
+* straight paths
+*
+* Precondition: subtreePtr points to a node of this binary search tree
+* Postcondition: The nodes on the path from subtreePtr to the root have been
+*    restructured and the binary search tree property is maintained
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+void BinarySearchTree::semiSplay(Node * subtreePtr)
+{
+	while (subtreePtr->parent != NULL && subtreePtr->parent->parent != NULL) {
+		Node * parent = subtreePtr->parent;
+		Node * grandparent = parent->parent;
+
+		// continue from the top of the restructured pair
+		if ((grandparent->left == parent) == (parent->left == subtreePtr)) { // zig-zig
+			rotateUp(parent);
+			subtreePtr = parent;
+		} else { // zig-zag
+			rotateUp(subtreePtr);
+			rotateUp(subtreePtr);
+		}
+	}
 }
 
 /*****************************************************************************/
@@ -702,6 +2723,7 @@ bool BinarySearchTree::remove(const DataType& item)
 
 void BinarySearchTree::displayGraphic(std::ostream& out) const
 {
+	applyPending();
 	displayGraphicHelper(out,0,_root);
 }
 
@@ -747,6 +2769,9 @@ BinarySearchTree& BinarySearchTree::operator=(const BinarySearchTree& rhs)
 		return *this;
 	}
 
+	rhs.applyPending();
+	_pending.clear();
+
 	copyBinarySearchTree(rhs._root, _root);
 
 	return *this;
@@ -781,7 +2806,7 @@ void BinarySearchTree::copyBinarySearchTree(Node * original, Node * &copy)
         copyBinarySearchTree(original->right,copy->right); //copies right subtree nodes
    }
    else   {
-       copy = new Node;
+       copy = createNode(DataType());
    }
 }
 
@@ -811,6 +2836,7 @@ Nodes on the same level should be visited in order from left to right*/
 
 void BinarySearchTree::levelByLevel(std::ostream& out)
 {
+    flush();
 
     if (_root == NULL) //if BST is not empty
         return;
@@ -840,4 +2866,120 @@ void BinarySearchTree::levelByLevel(std::ostream& out)
     }
 }
 
+/**
+* Level order traversal of Binary Search Tree into a sink
+*
+* Precondition: None
+* Postcondition: Values have been written to sink level by level, left to
+*    right within each level
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+void BinarySearchTree::levelByLevel(TraversalSink& sink)
+{
+	flush();
+
+	queue <Node *> q;
+	if (_root != NULL) {
+		q.push(_root);
+	}
+
+	while (!q.empty()) {
+		Node * subtreePtr = q.front();
+		q.pop();
+
+		sink.put(subtreePtr->data);
+
+		if (subtreePtr->left != NULL)
+			q.push(subtreePtr->left);
+		if (subtreePtr->right != NULL)
+			q.push(subtreePtr->right);
+	}
+
+	sink.endTraversal();
+}
+
+/**
+* Level order traversal of Binary Search Tree with callbacks. Nodes are
+* queued in a ring buffer local to the call, which only grows to the width
+* of the widest level visited, so concurrent and nested traversals of an
+* unbuffered tree do not interfere
+*
+* Precondition: visitor does not modify the tree
+* Postcondition: visitor has been called for every node on levels 0 through
+*    maxDepth (every level if maxDepth is negative), left to right, and after
+*    each level. Returns the number of levels visited
+*
+* Worst-Case Time Complexity: O(k), where k is the number of nodes visited
+*/
+
+int BinarySearchTree::levelOrder(LevelVisitor& visitor, int maxDepth) const
+{
+	applyPending();
+
+	std::vector<Node *> ring(LEVEL_RING_SIZE);
+	int head = 0;
+	int count = 0;
+	if (_root != NULL) {
+		levelPush(ring, _root, head, count);
+	}
+
+	int level = 0;
+	while (count > 0) {
+		// between levels the ring holds exactly the next level
+		int width = count;
+		bool descend = (maxDepth < 0 || level < maxDepth);
+
+		for (int i = 0; i < width; i++) {
+			Node * current = ring[head];
+			head = (head + 1) & ((int)ring.size() - 1);
+			count--;
+
+			visitor.visitNode(current->data, level);
+
+			if (descend && current->left != NULL) {
+				levelPush(ring, current->left, head, count);
+			}
+			if (descend && current->right != NULL) {
+				levelPush(ring, current->right, head, count);
+			}
+		}
+
+		level++;
+		if (!visitor.endLevel(level - 1, width)) {
+			break;
+		}
+	}
+
+	return level;
+}
+
+/**
+* Queue a node for the level order traversal
+*
+* Precondition: The ring holds count nodes starting at head, and its size is
+*    a power of two
+* Postcondition: subtreePtr is queued last. The ring has doubled, with the
+*    queue moved to its start, if it was full
+*
+* Worst-Case Time Complexity: O(1) amortized
+*/
+
+void BinarySearchTree::levelPush(std::vector<Node *>& ring, Node * subtreePtr, int &head, int &count)
+{
+	int capacity = (int)ring.size();
+
+	if (count == capacity) {
+		std::vector<Node *> larger(capacity * 2);
+		for (int i = 0; i < count; i++) {
+			larger[i] = ring[(head + i) & (capacity - 1)];
+		}
+		ring.swap(larger);
+		head = 0;
+		capacity *= 2;
+	}
 
+	ring[(head + count) & (capacity - 1)] = subtreePtr;
+	count++;
+}
@@ -3,32 +3,129 @@
 
 #include <iostream>
 #include <iomanip>
+#include <vector>
+#include <utility>
 
 const int INDENT_VALUE = 8;
+const int DEFAULT_BUFFER_LIMIT = 65536; // buffered operations per merge, chosen with bench buffered
+const int DIFF_SCAN_LIMIT = 16;
+const int LEVEL_RING_SIZE = 64; // initial level order queue, a power of two
+const int SPLAY_DEPTH_SLACK = 6; // levels below balanced height before access restructures
 typedef int DataType;
+typedef long long SumType;
+typedef unsigned long long HashType;
+
+class TraversalSink;
+class CountingBloomFilter;
+class CompressedKeySet;
+
+HashType hashItem(const DataType&);
+
+/**
+ * Which item a capacity-bounded tree evicts when it is full
+ *
+ * EVICT_MINIMUM  the smallest item
+ * EVICT_MAXIMUM  the largest item
+ * EVICT_LRU      the least recently inserted or found item
+ * EVICT_CLOCK    an item not found since the clock hand last passed it
+ */
+
+enum EvictionPolicy { EVICT_MINIMUM, EVICT_MAXIMUM, EVICT_LRU, EVICT_CLOCK };
+
+/**
+ * Callback for items evicted from a capacity-bounded tree
+ */
+
+class EvictionListener {
+   public:
+      virtual ~EvictionListener() {};
+
+      virtual void evicted(const DataType&) = 0;
+};
+
+/**
+ * Callbacks for a level order traversal
+ *
+ * visitNode is called for every node with its level (the root is level 0).
+ * endLevel is called after each level with the number of nodes on it; the
+ * traversal stops if it returns false
+ */
+
+class LevelVisitor {
+   public:
+      virtual ~LevelVisitor() {};
+
+      virtual void visitNode(const DataType&, int) = 0;
+      virtual bool endLevel(int, int) = 0;
+};
+
 /**
  * Class to hold binary search trees
  *
  * Note that this binary search requires that all items be unique
+ *
+ * Note that const members may merge buffered operations into the tree and
+ * update the eviction list, so const reads of one tree from several threads
+ * need the same locking as writes
  */
 
 class BinarySearchTree {
-   private:
+   protected:
       class Node {
          public:
             DataType data;
+            int count;   // number of nodes in this subtree
             Node * left;
             Node * right;
             Node * parent;
+            SumType sum; // sum of the items in this subtree
+            HashType hash;   // order-independent hash of the items in this subtree
 
-            Node():left(NULL),right(NULL),parent(NULL) {};
+            Node():data(),count(1),left(NULL),right(NULL),parent(NULL),sum(0),hash(0) {};
             Node(const DataType& item) {
                data=item;
+               count=1;
                left=NULL;
                right=NULL;
                parent=NULL;
+               sum=item;
+               hash=0;
             };
       };
+
+      // node layout of interval trees
+      class IntervalNode : public Node {
+         public:
+            DataType end;    // end of the interval starting at data
+            DataType maxEnd; // largest interval end in this subtree
+
+            IntervalNode(const DataType& item):Node(item),end(item),maxEnd(item) {};
+      };
+
+      // place of a node in the eviction list of an LRU or CLOCK bounded tree
+      class EvictionLinks {
+         public:
+            Node * lruPrev;  // more recently used neighbour in the eviction list
+            Node * lruNext;  // less recently used neighbour in the eviction list
+            bool referenced; // found since the clock hand last passed
+
+            EvictionLinks():lruPrev(NULL),lruNext(NULL),referenced(false) {};
+      };
+
+      // node layouts of LRU and CLOCK bounded trees
+      class LinkedNode : public Node {
+         public:
+            EvictionLinks links;
+
+            LinkedNode(const DataType& item):Node(item),links() {};
+      };
+
+      class LinkedIntervalNode : public IntervalNode {
+         public:
+            EvictionLinks links;
+
+            LinkedIntervalNode(const DataType& item):IntervalNode(item),links() {};
+      };
    public:
       BinarySearchTree();
       BinarySearchTree(BinarySearchTree&);
@@ -41,28 +138,104 @@ class BinarySearchTree {
       DataType getSuccessor(const DataType&) const;
       DataType getPredecessor(const DataType&) const;
       DataType getMinimum() const;
+      bool getFloor(const DataType&, DataType&) const;
+      bool getCeiling(const DataType&, DataType&) const;
+      bool getNearest(const DataType&, DataType&) const;
       DataType getMaximum() const;
       int getHeight() const;
       int getSize() const;
+      bool getByRank(int, DataType&) const;
+
+      int rangeCount(const DataType&, const DataType&) const;
+      SumType rangeSum(const DataType&, const DataType&) const;
+      bool rangeMinimum(const DataType&, const DataType&, DataType&) const;
+      bool rangeMaximum(const DataType&, const DataType&, DataType&) const;
+      void rangeScan(const DataType&, const DataType&, std::vector<DataType>&) const;
+
+      HashType getHash() const;
+      HashType rangeHash(const DataType&, const DataType&) const;
+      void diff(const BinarySearchTree&, std::vector<DataType>&, std::vector<DataType>&) const;
 
       void inorder(std::ostream&) const;
       void postorder(std::ostream&) const;
       void preorder(std::ostream&) const;
 
+      void inorder(TraversalSink&) const;
+      void postorder(TraversalSink&) const;
+      void preorder(TraversalSink&) const;
+
       bool insert(const DataType&);
       bool remove(const DataType&);
+      int eraseRange(const DataType&, const DataType&);
+      bool extractRange(const DataType&, const DataType&, BinarySearchTree&);
+
+      bool loadSorted(const std::vector<DataType>&);
+
+      void enableFilter(int, double);
+      void disableFilter();
+      bool isFiltered() const;
+
+      void setCapacity(int, EvictionPolicy);
+      void setByteBudget(long long, EvictionPolicy);
+      int getCapacity() const;
+      void setEvictionListener(EvictionListener *);
+
+      void setSelfAdjusting(bool);
+      bool isSelfAdjusting() const;
+      bool access(const DataType&);
+
+      void setBuffered(bool);
+      bool isBuffered() const;
+      void setBufferLimit(int);
+      int getPendingCount() const;
+      void flush();
 
       void displayGraphic(std::ostream&) const;
 
       BinarySearchTree& operator=(const BinarySearchTree& rhs);
 
       void levelByLevel(std::ostream&); //BONUS level order
+      void levelByLevel(TraversalSink&);
+      void compress(CompressedKeySet&) const;
+      int levelOrder(LevelVisitor&, int) const;
+
+   protected:
+      mutable Node * _root;              // const reads may merge the buffer
+      bool _intervals;                   // nodes are IntervalNodes
+
+      static IntervalNode * asInterval(Node * subtreePtr) { return static_cast<IntervalNode *>(subtreePtr); }
+      EvictionLinks * linksOf(Node * subtreePtr) const {
+         if (_intervals) {
+            return &static_cast<LinkedIntervalNode *>(subtreePtr)->links;
+         }
+         return &static_cast<LinkedNode *>(subtreePtr)->links;
+      }
+
+      Node * insertNode(const DataType&);
+      void refreshPath(Node *) const;
+      void enforceCapacity() const;
+      void applyPending() const;
 
    private:
-      Node * _root;
+      bool _selfAdjusting;
+      bool _buffered;
+      int _bufferLimit;
+      mutable std::vector<std::pair<DataType, bool> > _pending; // buffered operations in arrival order, true = insert
+      CountingBloomFilter * _filter;     // negative lookup filter, or NULL
+      int _capacity;                     // maximum number of nodes, 0 = unbounded
+      EvictionPolicy _evictionPolicy;
+      EvictionListener * _evictionListener;
+      bool _threaded;                    // nodes are linked into the eviction list, and carry EvictionLinks
+      mutable Node * _lruHead;           // most recently used
+      mutable Node * _lruTail;           // least recently used
+      mutable Node * _clockHand;
 
       void getHeightHelper(Node *, int *, int *) const;
-      void getSizeHelper(Node * , int * ) const;
+      void prefixAggregateHelper(const DataType&, bool, int &, SumType &, HashType &) const;
+      void rangeAggregate(const DataType&, const DataType&, int &, HashType &) const;
+      void diffHelper(const BinarySearchTree&, const DataType&, const DataType&,
+         std::vector<DataType>&, std::vector<DataType>&) const;
+      void rangeScanHelper(const DataType&, const DataType&, Node *, std::vector<DataType>&) const;
       void searchHelper(const DataType&, Node *, Node * &) const;
       void searchParent(const DataType&, Node *, Node * &) const;
       void getMaximumHelper(Node *, Node * &) const;
@@ -72,11 +245,46 @@ class BinarySearchTree {
       void preorderHelper(std::ostream&, Node *) const;
       void postorderHelper(std::ostream&, Node *) const;
 
+      void inorderHelper(TraversalSink&, Node *) const;
+      void compressHelper(CompressedKeySet&, Node *) const;
+      void preorderHelper(TraversalSink&, Node *) const;
+      void postorderHelper(TraversalSink&, Node *) const;
+
+      static void levelPush(std::vector<Node *>&, Node *, int &, int &);
+
       void displayGraphicHelper(std::ostream&, const int&, Node *) const;
 
 
       void getSuccessorHelper(Node *, Node * &) const;
       void getPredecessorHelper(Node *, Node * &) const;
+      void getBoundsHelper(const DataType&, Node * &, Node * &) const;
+
+      Node * createNode(const DataType&) const;
+      void freeNode(Node *) const;
+      void freeNode(Node *, bool) const;
+      long long getNodeBytes(bool) const;
+      Node * relayoutHelper(Node *, Node *, bool);
+
+      void addToFilterHelper(Node *);
+
+      Node * chooseVictim() const;
+      void threadHelper(Node *);
+      void linkNode(Node *) const;
+      void unlinkNode(Node *) const;
+      void replaceLinked(Node *, Node *) const;
+      void touch(Node *) const;
+
+      void refreshNode(Node *) const;
+      void removeNode(Node *) const;
+      void splitHelper(Node *, const DataType&, bool, Node * &, Node * &);
+      Node * joinHelper(Node *, Node *);
+      void eraseHelper(Node *);
+      Node * transferHelper(BinarySearchTree&, Node *, Node *);
+      void applyBatchHelper(Node * &, Node *, const std::vector<std::pair<DataType, bool> >&, int, int) const;
+      Node * buildBalanced(const std::vector<DataType>&, int, int, Node *) const;
+
+      void rotateUp(Node *);
+      void semiSplay(Node *);
 
       void copyBinarySearchTree(Node *, Node * &);
       void deleteBinarySearchTree(Node * &);
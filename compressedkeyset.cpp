@@ -0,0 +1,381 @@
+#include "compressedkeyset.h"
+
+using namespace std;
+
+/*****************************************************************************/
+/********************** Constructors *****************************************/
+/*****************************************************************************/
+
+/**
+* Construct an empty compressed key set
+*
+* Precondition: None
+* Postcondition: An empty key set ready for append() has been constructed
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+CompressedKeySet::CompressedKeySet()
+{
+	_bitLength = 0;
+	_size = 0;
+}
+
+/*****************************************************************************/
+/********************** Accessors ********************************************/
+/*****************************************************************************/
+
+/**
+* Search the key set for an item
+*
+* Precondition: finish() has been called
+* Postcondition: Returns true if item found, and false otherwise
+*
+* Worst-Case Time Complexity: O(log b + B), where b is the number of blocks
+*    and B the block size
+*/
+
+bool CompressedKeySet::search(const DataType& item) const
+{
+	int block = findBlock(item);
+	if (block < 0) {
+		return false;
+	}
+
+	DataType keys[COMPRESSED_BLOCK_SIZE];
+	int count = decodeBlock(block, keys);
+	for (int i = 0; i < count && !(item < keys[i]); i++) {
+		if (keys[i] == item) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+* Find the smallest key greater than item. Unlike getSuccessor in bst.h,
+* item does not need to be present
+*
+* Precondition: finish() has been called
+* Postcondition: Returns true and sets result to the successor if one
+*    exists. Returns false and leaves result unchanged otherwise
+*
+* Worst-Case Time Complexity: O(log b + B)
+*/
+
+bool CompressedKeySet::getSuccessor(const DataType& item, DataType& result) const
+{
+	if (_blockFirst.empty()) {
+		return false;
+	}
+
+	int block = findBlock(item);
+	if (block < 0) { // every key is greater than item
+		result = _blockFirst[0];
+		return true;
+	}
+
+	DataType keys[COMPRESSED_BLOCK_SIZE];
+	int count = decodeBlock(block, keys);
+	for (int i = 0; i < count; i++) {
+		if (item < keys[i]) {
+			result = keys[i];
+			return true;
+		}
+	}
+
+	// the successor starts the next block
+	if (block + 1 < (int)_blockFirst.size()) {
+		result = _blockFirst[block + 1];
+		return true;
+	}
+	return false;
+}
+
+/**
+* Collect the keys in the range [low, high]
+*
+* Precondition: finish() has been called
+* Postcondition: Every key x with low <= x <= high has been appended to
+*    result in increasing order
+*
+* Worst-Case Time Complexity: O(log b + B + k), where k is the number of
+*    keys reported
+*/
+
+void CompressedKeySet::rangeScan(const DataType& low, const DataType& high, std::vector<DataType>& result) const
+{
+	int block = findBlock(low);
+	if (block < 0) {
+		block = 0;
+	}
+
+	DataType keys[COMPRESSED_BLOCK_SIZE];
+	for (; block < (int)_blockFirst.size() && !(high < _blockFirst[block]); block++) {
+		int count = decodeBlock(block, keys);
+		for (int i = 0; i < count && !(high < keys[i]); i++) {
+			if (!(keys[i] < low)) {
+				result.push_back(keys[i]);
+			}
+		}
+	}
+}
+
+/**
+* Determine the number of keys
+*
+* Precondition: None
+* Postcondition: Returns the number of keys appended
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int CompressedKeySet::getSize() const
+{
+	return _size;
+}
+
+/**
+* Determine the memory used by the compressed form
+*
+* Precondition: finish() has been called
+* Postcondition: Returns the bytes held by the index and the packed gaps
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+long long CompressedKeySet::getByteSize() const
+{
+	long long indexBytes = (long long)_blockFirst.size()
+		* (sizeof(DataType) + sizeof(long long) + sizeof(unsigned char));
+	return indexBytes + (long long)_words.size() * sizeof(unsigned int);
+}
+
+/**
+* Determine the average memory used per key
+*
+* Precondition: finish() has been called
+* Postcondition: Returns bytes per key, or 0 for an empty set
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+double CompressedKeySet::getBytesPerKey() const
+{
+	if (_size == 0) {
+		return 0;
+	}
+	return (double)getByteSize() / _size;
+}
+
+/*****************************************************************************/
+/********************** Operations *******************************************/
+/*****************************************************************************/
+
+/**
+* Append a key to the set
+*
+* Precondition: finish() has not been called since the last clear()
+* Postcondition: Returns true if item was appended. Returns false if item is
+*    not greater than the last key appended
+*
+* Worst-Case Time Complexity: O(1) amortized
+*/
+
+bool CompressedKeySet::append(const DataType& item)
+{
+	if (!_building.empty() && !(_building.back() < item)) {
+		return false;
+	}
+	if (_building.empty() && !_blockFirst.empty()) {
+		DataType last[COMPRESSED_BLOCK_SIZE];
+		int count = decodeBlock((int)_blockFirst.size() - 1, last);
+		if (!(last[count - 1] < item)) {
+			return false;
+		}
+	}
+
+	_building.push_back(item);
+	_size++;
+
+	if ((int)_building.size() == COMPRESSED_BLOCK_SIZE) {
+		sealBlock();
+	}
+	return true;
+}
+
+/**
+* Seal the last, partly filled block
+*
+* Precondition: None
+* Postcondition: Every appended key is searchable
+*
+* Worst-Case Time Complexity: O(B)
+*/
+
+void CompressedKeySet::finish()
+{
+	if (!_building.empty()) {
+		sealBlock();
+	}
+}
+
+/**
+* Remove every key
+*
+* Precondition: None
+* Postcondition: The key set is empty and ready for append()
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void CompressedKeySet::clear()
+{
+	_blockFirst.clear();
+	_blockOffset.clear();
+	_blockWidth.clear();
+	_words.clear();
+	_building.clear();
+	_bitLength = 0;
+	_size = 0;
+}
+
+/*****************************************************************************/
+/********************** Functions ********************************************/
+/*****************************************************************************/
+
+/**
+* Encode the unfinished block. Gaps are stored minus one, since keys are
+* strictly increasing, so runs of consecutive keys take zero bits
+*
+* Precondition: The unfinished block is not empty
+* Postcondition: The block has been packed and indexed
+*
+* Worst-Case Time Complexity: O(B)
+*/
+
+void CompressedKeySet::sealBlock()
+{
+	// unsigned arithmetic keeps gaps exact across the whole DataType range
+	unsigned int largest = 0;
+	for (size_t i = 1; i < _building.size(); i++) {
+		unsigned int gap = (unsigned int)_building[i] - (unsigned int)_building[i - 1] - 1;
+		if (gap > largest) {
+			largest = gap;
+		}
+	}
+
+	int width = 0;
+	while (width < 32 && (largest >> width) != 0) {
+		width++;
+	}
+
+	_blockFirst.push_back(_building[0]);
+	_blockOffset.push_back(_bitLength);
+	_blockWidth.push_back((unsigned char)width);
+
+	for (size_t i = 1; i < _building.size() && width > 0; i++) {
+		unsigned int gap = (unsigned int)_building[i] - (unsigned int)_building[i - 1] - 1;
+
+		size_t word = (size_t)(_bitLength >> 5);
+		int shift = (int)(_bitLength & 31);
+		while (_words.size() < word + 2) {
+			_words.push_back(0);
+		}
+
+		_words[word] |= gap << shift;
+		if (shift + width > 32) {
+			_words[word + 1] |= gap >> (32 - shift);
+		}
+		_bitLength += width;
+	}
+
+	// drop the spare word if the block ended on a word boundary
+	_words.resize((size_t)((_bitLength + 31) >> 5));
+
+	_building.clear();
+}
+
+/**
+* Find the block that could hold item
+*
+* Precondition: None
+* Postcondition: Returns the last block whose first key is not greater than
+*    item, or -1 if there is none
+*
+* Worst-Case Time Complexity: O(log b)
+*/
+
+int CompressedKeySet::findBlock(const DataType& item) const
+{
+	int low = 0;
+	int high = (int)_blockFirst.size();
+
+	while (low < high) {
+		int middle = low + (high - low) / 2;
+		if (item < _blockFirst[middle]) {
+			high = middle;
+		} else {
+			low = middle + 1;
+		}
+	}
+
+	return low - 1;
+}
+
+/**
+* Determine the number of keys in a block
+*
+* Precondition: 0 <= block < number of blocks
+* Postcondition: Returns the block size, or the remainder for the last block
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int CompressedKeySet::getBlockCount(int block) const
+{
+	if (block + 1 < (int)_blockFirst.size()) {
+		return COMPRESSED_BLOCK_SIZE;
+	}
+	return _size - block * COMPRESSED_BLOCK_SIZE - (int)_building.size();
+}
+
+/**
+* Decode the keys of a block
+*
+* Precondition: 0 <= block < number of blocks. keys has room for a block
+* Postcondition: The keys of the block have been written to keys in
+*    increasing order. Returns the number of keys
+*
+* Worst-Case Time Complexity: O(B)
+*/
+
+int CompressedKeySet::decodeBlock(int block, DataType * keys) const
+{
+	int count = getBlockCount(block);
+	int width = _blockWidth[block];
+	unsigned int mask = (width == 32) ? 0xffffffffu : ((1u << width) - 1);
+	long long position = _blockOffset[block];
+
+	unsigned int value = (unsigned int)_blockFirst[block];
+	keys[0] = (DataType)value;
+
+	for (int i = 1; i < count; i++) {
+		unsigned int gap = 0;
+		if (width > 0) {
+			size_t word = (size_t)(position >> 5);
+			int shift = (int)(position & 31);
+			gap = _words[word] >> shift;
+			if (shift + width > 32) {
+				gap |= _words[word + 1] << (32 - shift);
+			}
+			gap &= mask;
+			position += width;
+		}
+
+		value += gap + 1;
+		keys[i] = (DataType)value;
+	}
+
+	return count;
+}
@@ -0,0 +1,52 @@
+#ifndef COMPRESSEDKEYSET_H_
+#define COMPRESSEDKEYSET_H_
+
+#include <vector>
+#include "bst.h"
+
+const int COMPRESSED_BLOCK_SIZE = 128;
+
+/**
+ * Class to hold an immutable, compressed, sorted key set
+ *
+ * Keys are grouped into blocks of 128. A sparse index holds the first key
+ * of every block. The remaining keys of a block are stored as gaps from
+ * the previous key, bit-packed at the smallest width that fits the largest
+ * gap in the block (frame of reference). Lookups binary search the index
+ * and decode a single block
+ *
+ * Note that DataType must be an integer type of at most 32 bits
+ */
+
+class CompressedKeySet {
+   public:
+      CompressedKeySet();
+
+      bool search(const DataType&) const;
+      bool getSuccessor(const DataType&, DataType&) const;
+      void rangeScan(const DataType&, const DataType&, std::vector<DataType>&) const;
+
+      int getSize() const;
+      long long getByteSize() const;
+      double getBytesPerKey() const;
+
+      bool append(const DataType&);
+      void finish();
+      void clear();
+
+   private:
+      std::vector<DataType> _blockFirst;       // sparse index: first key of each block
+      std::vector<long long> _blockOffset;     // bit offset of each block's gaps
+      std::vector<unsigned char> _blockWidth;  // bits per gap in each block
+      std::vector<unsigned int> _words;        // bit-packed gaps of every block
+      std::vector<DataType> _building;         // keys of the unfinished block
+      long long _bitLength;
+      int _size;
+
+      void sealBlock();
+      int findBlock(const DataType&) const;
+      int getBlockCount(int) const;
+      int decodeBlock(int, DataType *) const;
+};
+
+#endif /* COMPRESSEDKEYSET_H_ */
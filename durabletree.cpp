@@ -0,0 +1,619 @@
+#include "durabletree.h"
+#include "traversalsink.h"
+#include <vector>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+// log record: operation byte, key, checksum of the two
+static const int RECORD_SIZE = 1 + sizeof(DataType) + sizeof(unsigned int);
+static const char OP_INSERT = 'I';
+static const char OP_REMOVE = 'R';
+
+// checkpoint header: magic followed by the number of keys
+static const char CHECKPOINT_MAGIC[8] = { 'B', 'S', 'T', 'C', 'K', 'P', 'T', '1' };
+static const int CHECKPOINT_HEADER_SIZE = sizeof(CHECKPOINT_MAGIC) + sizeof(long long);
+
+/**
+* FNV-1a checksum of a byte range, used to detect torn log records
+*/
+
+static unsigned int checksum(const char * bytes, int length)
+{
+	unsigned int hash = 2166136261u;
+	for (int i = 0; i < length; i++) {
+		hash ^= (unsigned char)bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+* Write a whole byte range to a file descriptor, retrying partial writes
+*/
+
+static bool writeAll(int fd, const char * bytes, int length)
+{
+	while (length > 0) {
+		ssize_t count = ::write(fd, bytes, length);
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		bytes += count;
+		length -= (int)count;
+	}
+	return true;
+}
+
+/**
+* Read a whole byte range from a file descriptor. Returns the number of
+* bytes read, which is less than length only at end of file or on error
+*/
+
+static int readAll(int fd, char * bytes, int length)
+{
+	int total = 0;
+	while (total < length) {
+		ssize_t count = ::read(fd, bytes + total, length - total);
+		if (count < 0 && errno == EINTR) {
+			continue;
+		}
+		if (count <= 0) {
+			break;
+		}
+		total += (int)count;
+	}
+	return total;
+}
+
+/*****************************************************************************/
+/********************** Constructors *****************************************/
+/*****************************************************************************/
+
+/**
+* Construct a durable tree stored in a directory
+*
+* Precondition: groupSize is positive
+* Postcondition: An empty, closed durable tree has been constructed. open()
+*    must be called to recover its contents before use
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+DurableTree::DurableTree(const std::string& directory, SyncPolicy policy, int groupSize)
+{
+	_directory = directory;
+	_policy = policy;
+	_groupSize = groupSize;
+	_checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+	_logFd = -1;
+	_logLength = 0;
+	_fileLength = 0;
+	_failed = false;
+	_unsynced = 0;
+	_logRecords = 0;
+	_replayed = 0;
+}
+
+/*****************************************************************************/
+/********************** Destructor *******************************************/
+/*****************************************************************************/
+
+/**
+* Destructor for a durable tree
+*
+* Precondition: The life of the durable tree is over
+* Postcondition: The log has been synced and closed
+*
+* Worst-Case Time Complexity: O(n) for the tree, plus one sync
+*/
+
+DurableTree::~DurableTree()
+{
+	close();
+}
+
+/*****************************************************************************/
+/********************** Recovery *********************************************/
+/*****************************************************************************/
+
+/**
+* Recover the tree from its directory and open the log for appending
+*
+* Precondition: The tree has not been opened before
+* Postcondition: The tree holds the latest checkpoint with the log replayed
+*    on top. A torn record at the end of the log has been truncated away.
+*    Returns false on an I/O error or a corrupt checkpoint
+*
+* Worst-Case Time Complexity: O(n + r * h), where r is the number of log
+*    records replayed
+*/
+
+bool DurableTree::open()
+{
+	if (_logFd >= 0 || !_tree.isEmpty()) {
+		return false;
+	}
+
+	if (::mkdir(_directory.c_str(), 0755) != 0 && errno != EEXIST) {
+		return false;
+	}
+
+	if (!loadCheckpoint()) {
+		return false;
+	}
+
+	_logFd = ::open(getLogPath().c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+	if (_logFd < 0) {
+		return false;
+	}
+
+	return replayLog();
+}
+
+/**
+* Load the latest checkpoint, if any, as a balanced tree
+*
+* Precondition: The tree is empty
+* Postcondition: The tree holds the keys of the checkpoint. Returns true if
+*    there is no checkpoint and false if it cannot be read or is corrupt
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+bool DurableTree::loadCheckpoint()
+{
+	int fd = ::open(getCheckpointPath().c_str(), O_RDONLY);
+	if (fd < 0) {
+		return (errno == ENOENT);
+	}
+
+	char header[CHECKPOINT_HEADER_SIZE];
+	long long count = 0;
+	bool valid = (readAll(fd, header, CHECKPOINT_HEADER_SIZE) == CHECKPOINT_HEADER_SIZE
+		&& memcmp(header, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) == 0);
+
+	std::vector<DataType> keys;
+	if (valid) {
+		memcpy(&count, header + sizeof(CHECKPOINT_MAGIC), sizeof(count));
+		valid = (count >= 0);
+	}
+	if (valid) {
+		keys.resize((size_t)count);
+		int length = (int)(count * sizeof(DataType));
+		valid = (readAll(fd, reinterpret_cast<char *>(keys.data()), length) == length);
+	}
+
+	::close(fd);
+
+	return valid && _tree.loadSorted(keys);
+}
+
+/**
+* Replay the log on top of the loaded checkpoint. Replaying is idempotent,
+* since the last record for a key decides whether it is present, so records
+* already covered by the checkpoint are harmless
+*
+* Precondition: The log is open
+* Postcondition: Every complete, valid record has been applied in order. The
+*    log has been truncated after the last valid record
+*
+* Worst-Case Time Complexity: O(r * h), where r is the number of records
+*/
+
+bool DurableTree::replayLog()
+{
+	if (::lseek(_logFd, 0, SEEK_SET) < 0) {
+		return false;
+	}
+
+	std::vector<char> chunk(RECORD_SIZE * 4096);
+	off_t validLength = 0;
+	bool torn = false;
+
+	while (!torn) {
+		int length = readAll(_logFd, chunk.data(), (int)chunk.size());
+
+		int offset = 0;
+		for (; offset + RECORD_SIZE <= length; offset += RECORD_SIZE) {
+			const char * record = chunk.data() + offset;
+			unsigned int stored;
+			memcpy(&stored, record + 1 + sizeof(DataType), sizeof(stored));
+
+			if (stored != checksum(record, 1 + sizeof(DataType))) {
+				torn = true;
+				break;
+			}
+
+			DataType item;
+			memcpy(&item, record + 1, sizeof(DataType));
+			if (record[0] == OP_INSERT) {
+				_tree.insert(item);
+			} else {
+				_tree.remove(item);
+			}
+
+			validLength += RECORD_SIZE;
+			_replayed++;
+		}
+
+		// a partial record can only be the torn tail of the log
+		if (offset < length) {
+			torn = true;
+		}
+		if (length < (int)chunk.size()) {
+			break;
+		}
+	}
+
+	_logRecords = _replayed;
+	_fileLength = validLength;
+
+	// drop the torn tail so new records follow the last valid one
+	return (::ftruncate(_logFd, validLength) == 0);
+}
+
+/*****************************************************************************/
+/********************** Accessors ********************************************/
+/*****************************************************************************/
+
+/**
+* Search the tree for an item
+*
+* Precondition: None
+* Postcondition: Returns true if item found, and false otherwise
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool DurableTree::search(const DataType& item) const
+{
+	return _tree.search(item);
+}
+
+/**
+* Read-only access to the underlying tree
+*
+* Precondition: None
+* Postcondition: Returns the tree holding the current contents
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+const BinarySearchTree& DurableTree::getTree() const
+{
+	return _tree;
+}
+
+/**
+* Determine how many log records were replayed by open()
+*
+* Precondition: None
+* Postcondition: Returns the number of records replayed during recovery
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int DurableTree::getReplayedCount() const
+{
+	return _replayed;
+}
+
+/**
+* Check if the log has failed
+*
+* Precondition: None
+* Postcondition: Returns true if an I/O error left the log in a state that
+*    cannot be trusted. insert and remove then always return false
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+bool DurableTree::hasFailed() const
+{
+	return _failed;
+}
+
+/*****************************************************************************/
+/********************** Operations *******************************************/
+/*****************************************************************************/
+
+/**
+* Insert item, logging it before the tree is changed
+*
+* Precondition: The tree is open
+* Postcondition: Returns true if item was logged and inserted. Returns false
+*    if item was already present or the log could not be written
+*
+* Worst-Case Time Complexity: O(h), plus a sync or checkpoint when due
+*/
+
+bool DurableTree::insert(const DataType& item)
+{
+	if (_tree.search(item) || !appendRecord(OP_INSERT, item)) {
+		return false;
+	}
+
+	_tree.insert(item);
+	maybeCheckpoint();
+	return true;
+}
+
+/**
+* Remove item, logging it before the tree is changed
+*
+* Precondition: The tree is open
+* Postcondition: Returns true if item was logged and removed. Returns false
+*    if item was not present or the log could not be written
+*
+* Worst-Case Time Complexity: O(h), plus a sync or checkpoint when due
+*/
+
+bool DurableTree::remove(const DataType& item)
+{
+	if (!_tree.search(item) || !appendRecord(OP_REMOVE, item)) {
+		return false;
+	}
+
+	_tree.remove(item);
+	maybeCheckpoint();
+	return true;
+}
+
+/**
+* Commit every buffered log record to disk
+*
+* Precondition: None
+* Postcondition: All logged operations are durable. Returns false on an I/O
+*    error. A failed fdatasync may have lost earlier writes, so it marks the
+*    log failed
+*
+* Worst-Case Time Complexity: O(b), plus one fdatasync
+*/
+
+bool DurableTree::sync()
+{
+	if (_logFd < 0 || !writeLogBuffer()) {
+		return false;
+	}
+	if (::fdatasync(_logFd) != 0) {
+		_failed = true;
+		return false;
+	}
+
+	_unsynced = 0;
+	return true;
+}
+
+/**
+* Write the full key set to a new checkpoint and reset the log. The
+* checkpoint is written to a temporary file, synced and renamed into place,
+* so a crash at any point leaves either the old or the new checkpoint
+*
+* Precondition: The tree is open
+* Postcondition: The checkpoint holds the current keys and the log is empty.
+*    Returns false on an I/O error, in which case the log is kept
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+bool DurableTree::checkpoint()
+{
+	if (!sync()) {
+		return false;
+	}
+
+	std::string temporaryPath = getCheckpointPath() + ".tmp";
+	int fd = ::open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return false;
+	}
+
+	char header[CHECKPOINT_HEADER_SIZE];
+	long long count = _tree.getSize();
+	memcpy(header, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+	memcpy(header + sizeof(CHECKPOINT_MAGIC), &count, sizeof(count));
+
+	bool written = writeAll(fd, header, CHECKPOINT_HEADER_SIZE);
+	if (written) {
+		TraversalSink sink(fd, FORMAT_BINARY);
+		_tree.inorder(sink);
+		written = sink.flush();
+	}
+	written = written && (::fsync(fd) == 0);
+	::close(fd);
+
+	if (!written || ::rename(temporaryPath.c_str(), getCheckpointPath().c_str()) != 0) {
+		::unlink(temporaryPath.c_str());
+		return false;
+	}
+
+	// make the rename itself durable before dropping the log
+	int directoryFd = ::open(_directory.c_str(), O_RDONLY);
+	if (directoryFd >= 0) {
+		::fsync(directoryFd);
+		::close(directoryFd);
+	}
+
+	if (::ftruncate(_logFd, 0) != 0 || ::fdatasync(_logFd) != 0) {
+		_failed = true;
+		return false;
+	}
+
+	_fileLength = 0;
+	_logRecords = 0;
+	return true;
+}
+
+/**
+* Set how many log records trigger an automatic checkpoint
+*
+* Precondition: records is positive
+* Postcondition: A checkpoint is taken whenever the log holds records
+*    records
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void DurableTree::setCheckpointInterval(int records)
+{
+	_checkpointInterval = records;
+}
+
+/**
+* Sync and close the log
+*
+* Precondition: None
+* Postcondition: All logged operations are durable and the log is closed
+*
+* Worst-Case Time Complexity: O(b), plus one fdatasync
+*/
+
+void DurableTree::close()
+{
+	if (_logFd < 0) {
+		return;
+	}
+
+	sync();
+	::close(_logFd);
+	_logFd = -1;
+}
+
+/*****************************************************************************/
+/********************** Functions ********************************************/
+/*****************************************************************************/
+
+/**
+* Append a record to the log according to the sync policy
+*
+* Precondition: The tree is open
+* Postcondition: The record is buffered, written or committed as the sync
+*    policy requires. Returns false if the log could not be written or has
+*    failed, in which case the record is not in the log
+*
+* Worst-Case Time Complexity: O(1), plus a write or sync when due
+*/
+
+bool DurableTree::appendRecord(char operation, const DataType& item)
+{
+	if (_logFd < 0 || _failed) {
+		return false;
+	}
+
+	if (_logLength + RECORD_SIZE > LOG_BUFFER_SIZE && !writeLogBuffer()) {
+		return false;
+	}
+
+	off_t recordStart = _fileLength + _logLength;
+	char * record = _logBuffer + _logLength;
+	record[0] = operation;
+	memcpy(record + 1, &item, sizeof(DataType));
+	unsigned int sum = checksum(record, 1 + sizeof(DataType));
+	memcpy(record + 1 + sizeof(DataType), &sum, sizeof(sum));
+
+	_logLength += RECORD_SIZE;
+	_unsynced++;
+	_logRecords++;
+
+	if (_policy == SYNC_ALWAYS || (_policy == SYNC_GROUP && _unsynced >= _groupSize)) {
+		if (!sync()) {
+			// the caller is told this operation failed, so recovery must not see it
+			discardLog(recordStart);
+			_unsynced--;
+			_logRecords--;
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+* Take a checkpoint once the log has grown past the checkpoint interval
+*
+* Precondition: The logged operations have been applied to the tree
+* Postcondition: The log has been reset if it was due and the checkpoint
+*    succeeded. A failed checkpoint keeps the log, so nothing is lost
+*
+* Worst-Case Time Complexity: O(1), or O(n) when a checkpoint is due
+*/
+
+void DurableTree::maybeCheckpoint()
+{
+	if (_logRecords >= _checkpointInterval) {
+		checkpoint();
+	}
+}
+
+/**
+* Write the log buffer to the log file without syncing
+*
+* Precondition: The tree is open
+* Postcondition: The log buffer is empty. Returns false on an I/O error, in
+*    which case the buffer is kept and any partial write is cut off the file
+*
+* Worst-Case Time Complexity: O(b), where b is the size of the buffer
+*/
+
+bool DurableTree::writeLogBuffer()
+{
+	if (!writeAll(_logFd, _logBuffer, _logLength)) {
+		discardLog(_fileLength + _logLength);
+		return false;
+	}
+
+	_fileLength += _logLength;
+	_logLength = 0;
+	return true;
+}
+
+/**
+* Cut the log back to a length, whether the bytes past it are still in the
+* buffer or already in the file
+*
+* Precondition: length is not greater than the logical length of the log
+* Postcondition: The log, buffer included, ends at length. The log is marked
+*    failed if the file could not be truncated
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void DurableTree::discardLog(off_t length)
+{
+	if (length >= _fileLength) {
+		_logLength = (int)(length - _fileLength);
+	} else {
+		_logLength = 0;
+		_fileLength = length;
+	}
+
+	// drop anything past the written part of the file, such as a partial write
+	if (::ftruncate(_logFd, _fileLength) != 0) {
+		_failed = true;
+	}
+}
+
+/**
+* Determine the path of the log file
+*/
+
+std::string DurableTree::getLogPath() const
+{
+	return _directory + "/wal.log";
+}
+
+/**
+* Determine the path of the checkpoint file
+*/
+
+std::string DurableTree::getCheckpointPath() const
+{
+	return _directory + "/checkpoint";
+}
@@ -0,0 +1,89 @@
+#ifndef DURABLETREE_H_
+#define DURABLETREE_H_
+
+#include <string>
+#include <sys/types.h>
+#include "bst.h"
+
+const int DEFAULT_GROUP_SIZE = 256;
+const int DEFAULT_CHECKPOINT_INTERVAL = 1 << 20;
+const int LOG_BUFFER_SIZE = 1 << 16;
+
+/**
+ * When the write-ahead log is forced to disk
+ *
+ * SYNC_ALWAYS  every operation is written and fdatasync'd before returning
+ * SYNC_GROUP   operations are committed together every group size
+ *              operations, so at most one group is lost in a crash
+ * SYNC_NONE    the log is written as its buffer fills and the operating
+ *              system decides when it reaches disk
+ */
+
+enum SyncPolicy { SYNC_ALWAYS, SYNC_GROUP, SYNC_NONE };
+
+/**
+ * Class to hold a binary search tree backed by a write-ahead log
+ *
+ * Every successful insert and remove is appended to a log in a directory on
+ * local disk. Checkpoints write the full key set in sorted binary form and
+ * reset the log. Recovery loads the latest checkpoint as a balanced tree and
+ * replays the log tail, stopping at the first torn or corrupt record
+ *
+ * An operation that fails to reach the log is removed from it again, so
+ * recovery never replays an operation the caller was told had failed. If
+ * that is impossible, or fdatasync fails and the durability of earlier
+ * operations is unknown, the tree refuses further writes
+ */
+
+class DurableTree {
+   public:
+      DurableTree(const std::string&, SyncPolicy, int = DEFAULT_GROUP_SIZE);
+
+      ~DurableTree();
+
+      bool open();
+      void close();
+
+      bool search(const DataType&) const;
+      const BinarySearchTree& getTree() const;
+      int getReplayedCount() const;
+      bool hasFailed() const;
+
+      bool insert(const DataType&);
+      bool remove(const DataType&);
+
+      bool sync();
+      bool checkpoint();
+      void setCheckpointInterval(int);
+
+   private:
+      BinarySearchTree _tree;
+      std::string _directory;
+      SyncPolicy _policy;
+      int _groupSize;
+      int _checkpointInterval;
+      int _logFd;
+      char _logBuffer[LOG_BUFFER_SIZE];
+      int _logLength;
+      off_t _fileLength;                 // bytes of the log file already written
+      bool _failed;
+      int _unsynced;
+      int _logRecords;
+      int _replayed;
+
+      bool appendRecord(char, const DataType&);
+      bool writeLogBuffer();
+      void discardLog(off_t);
+      void maybeCheckpoint();
+      bool loadCheckpoint();
+      bool replayLog();
+
+      std::string getLogPath() const;
+      std::string getCheckpointPath() const;
+
+      // the log file descriptor has a single owner
+      DurableTree(const DurableTree&);
+      DurableTree& operator=(const DurableTree&);
+};
+
+#endif /* DURABLETREE_H_ */
@@ -0,0 +1,132 @@
+#include "intervaltree.h"
+
+using namespace std;
+
+/*****************************************************************************/
+/********************** Constructors *****************************************/
+/*****************************************************************************/
+
+/**
+* Construct an Interval Tree Object
+*
+* Precondition: None
+* Postcondition: An empty interval tree has been constructed
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+IntervalTree::IntervalTree()
+{
+	_intervals = true;
+}
+
+/*****************************************************************************/
+/********************** Accessors ********************************************/
+/*****************************************************************************/
+
+/**
+* Find every interval that overlaps [low, high]
+*
+* Precondition: None
+* Postcondition: Every interval [start, end] with start <= high and
+*    end >= low has been appended to result in order of start
+*
+* Worst-Case Time Complexity: O(h + k log n) for k reported intervals in a
+*    balanced tree; O(n) in the worst case
+*/
+
+void IntervalTree::findOverlapping(const DataType& low, const DataType& high, std::vector<Interval>& result) const
+{
+	applyPending();
+	findOverlappingHelper(low, high, _root, result);
+}
+
+/**
+* Find every interval that contains point
+*
+* Precondition: None
+* Postcondition: Every interval [start, end] with start <= point <= end has
+*    been appended to result in order of start
+*
+* Worst-Case Time Complexity: O(h + k log n) for k reported intervals in a
+*    balanced tree; O(n) in the worst case
+*/
+
+void IntervalTree::findContaining(const DataType& point, std::vector<Interval>& result) const
+{
+	findOverlapping(point, point, result);
+}
+
+/*****************************************************************************/
+/********************** Operations *******************************************/
+/*****************************************************************************/
+
+/**
+* Insert the interval [start, end] into the interval tree
+*
+* Precondition: end is not less than start. No interval with this start is
+*    present in the tree
+* Postcondition: Returns true if the interval was inserted and false
+*    otherwise. Buffered operations are applied first
+*
+* Worst-Case Time Complexity: O(h), where h is the height of the tree
+*/
+
+bool IntervalTree::insertInterval(const DataType& start, const DataType& end)
+{
+	if (end < start) {
+		return false;
+	}
+
+	flush();
+
+	Node * newNode = insertNode(start);
+	if (newNode == NULL) {
+		return false;
+	}
+
+	asInterval(newNode)->end = end;
+	refreshPath(newNode);
+	enforceCapacity();
+
+	return true;
+}
+
+/*****************************************************************************/
+/********************** Functions ********************************************/
+/*****************************************************************************/
+
+/**
+* Overlap search helper function
+*
+* Precondition: subtreePtr points to a subtree of this interval tree
+* Postcondition: Every interval of the subtree overlapping [low, high] has
+*    been appended to result in order of start
+*
+* Worst-Case Time Complexity: O(s), where s is the size of the subtree
+*/
+
+void IntervalTree::findOverlappingHelper(const DataType& low, const DataType& high, Node * subtreePtr, std::vector<Interval>& result) const
+{
+	// no interval in this subtree reaches low
+	if (subtreePtr == NULL || asInterval(subtreePtr)->maxEnd < low) {
+		return;
+	}
+
+	findOverlappingHelper(low, high, subtreePtr->left, result);
+
+	// this interval and everything to its right start after high
+	if (high < subtreePtr->data) {
+		return;
+	}
+
+	DataType end = asInterval(subtreePtr)->end;
+	if (!(end < low)) {
+		Interval interval;
+		interval.start = subtreePtr->data;
+		interval.end = end;
+		result.push_back(interval);
+	}
+
+	findOverlappingHelper(low, high, subtreePtr->right, result);
+}
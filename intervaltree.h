@@ -0,0 +1,42 @@
+#ifndef INTERVALTREE_H_
+#define INTERVALTREE_H_
+
+#include <vector>
+#include "bst.h"
+
+/**
+ * Closed interval [start, end] stored by an interval tree keyed on start
+ */
+
+struct Interval {
+   DataType start;
+   DataType end;
+};
+
+/**
+ * Class to hold interval trees
+ *
+ * An interval tree is a binary search tree keyed on interval start whose
+ * nodes also hold the interval end and the largest end in their subtree, so
+ * overlap searches skip whole subtrees. A plain insert(item) stores the
+ * interval [item, item]. Only interval trees use the larger node layout
+ *
+ * Note that, like BinarySearchTree, all starts must be unique
+ */
+
+class IntervalTree : public BinarySearchTree {
+   public:
+      IntervalTree();
+
+      bool insertInterval(const DataType&, const DataType&);
+      void findOverlapping(const DataType&, const DataType&, std::vector<Interval>&) const;
+      void findContaining(const DataType&, std::vector<Interval>&) const;
+
+   private:
+      IntervalTree(const IntervalTree&);
+      IntervalTree& operator=(const IntervalTree&);
+
+      void findOverlappingHelper(const DataType&, const DataType&, Node *, std::vector<Interval>&) const;
+};
+
+#endif /* INTERVALTREE_H_ */
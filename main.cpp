@@ -79,6 +79,26 @@ int main()
      cout<<std::endl;
      cout<<std::endl;
 
+    //Checks nearest item queries at the ends of the int range
+    cout<<"Nearest with extreme keys: -2000000000, 2000000000"<< std::endl;
+    BinarySearchTree extremes;
+    extremes.insert(-2000000000);
+    extremes.insert(2000000000);
+
+    DataType nearest = 0;
+    extremes.getNearest(1500000000, nearest);
+    cout<<"Nearest to 1500000000: "<<nearest
+        <<(nearest == 2000000000 ? " (ok)" : " (WRONG)")<<std::endl;
+    extremes.getNearest(-1500000000, nearest);
+    cout<<"Nearest to -1500000000: "<<nearest
+        <<(nearest == -2000000000 ? " (ok)" : " (WRONG)")<<std::endl;
+    extremes.getNearest(0, nearest);
+    cout<<"Nearest to 0: "<<nearest
+        <<(nearest == -2000000000 ? " (ok)" : " (WRONG)")<<std::endl;
+
+     cout<<std::endl;
+     cout<<std::endl;
+
 
 
 
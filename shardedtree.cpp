@@ -0,0 +1,518 @@
+#include "shardedtree.h"
+
+using namespace std;
+
+/*****************************************************************************/
+/********************** Constructors *****************************************/
+/*****************************************************************************/
+
+/**
+* Construct a sharded forest with the range [low, high] split evenly
+*
+* Precondition: low < high. shards is positive
+* Postcondition: shards empty trees have been constructed. Keys below low
+*    go to the first shard and keys above high go to the last
+*
+* Worst-Case Time Complexity: O(shards)
+*/
+
+ShardedTree::ShardedTree(const DataType& low, const DataType& high, int shards)
+{
+	_skewFactor = DEFAULT_SKEW_FACTOR;
+
+	long long width = (long long)high - (long long)low + 1;
+	for (int i = 0; i < shards; i++) {
+		_shards.push_back(new Shard((DataType)(low + width * i / shards)));
+	}
+}
+
+/*****************************************************************************/
+/********************** Destructor *******************************************/
+/*****************************************************************************/
+
+/**
+* Destructor for a sharded forest
+*
+* Precondition: The life of the forest is over and no thread is using it
+* Postcondition: Every shard has been freed
+*
+* Worst-Case Time Complexity: O(n)
+*/
+
+ShardedTree::~ShardedTree()
+{
+	for (size_t i = 0; i < _shards.size(); i++) {
+		delete _shards[i];
+	}
+}
+
+/*****************************************************************************/
+/********************** Accessors ********************************************/
+/*****************************************************************************/
+
+/**
+* Search the forest for an item
+*
+* Precondition: None
+* Postcondition: Returns true if item found, and false otherwise
+*
+* Worst-Case Time Complexity: O(log s + h), where s is the number of shards
+*    and h is the height of the owning shard's tree
+*/
+
+bool ShardedTree::search(const DataType& item) const
+{
+	int index = lockShard(item);
+	lock_guard<mutex> guard(_shards[index]->lock, adopt_lock);
+
+	return _shards[index]->tree.search(item);
+}
+
+/**
+* Determine the number of items in the forest
+*
+* Precondition: None
+* Postcondition: Returns the number of items held by all shards. The value
+*    may be stale while writers are active
+*
+* Worst-Case Time Complexity: O(s), where s is the number of shards
+*/
+
+int ShardedTree::getSize() const
+{
+	int size = 0;
+	for (size_t i = 0; i < _shards.size(); i++) {
+		size += _shards[i]->size.load();
+	}
+
+	return size;
+}
+
+/**
+* Determine the number of shards
+*
+* Precondition: None
+* Postcondition: Returns the number of shards
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int ShardedTree::getShardCount() const
+{
+	return (int)_shards.size();
+}
+
+/**
+* Determine the number of items held by one shard
+*
+* Precondition: 0 <= index < getShardCount()
+* Postcondition: Returns the number of items in the shard. The value may be
+*    stale while writers are active
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int ShardedTree::getShardSize(int index) const
+{
+	return _shards[index]->size.load();
+}
+
+/**
+* Count the items in the range [low, high] across the shards it overlaps
+*
+* Precondition: None
+* Postcondition: Returns the number of items x with low <= x <= high at a
+*    single point in time
+*
+* Worst-Case Time Complexity: O(log s + r * h), where r is the number of
+*    shards overlapping the range
+*/
+
+int ShardedTree::rangeCount(const DataType& low, const DataType& high) const
+{
+	if (high < low) {
+		return 0;
+	}
+
+	int first;
+	int last;
+	lockRange(low, high, first, last);
+
+	int count = 0;
+	for (int i = first; i <= last; i++) {
+		count += _shards[i]->tree.rangeCount(low, high);
+	}
+
+	unlockRange(first, last);
+	return count;
+}
+
+/**
+* Sum the items in the range [low, high] across the shards it overlaps
+*
+* Precondition: None
+* Postcondition: Returns the sum of the items x with low <= x <= high at a
+*    single point in time
+*
+* Worst-Case Time Complexity: O(log s + r * h), where r is the number of
+*    shards overlapping the range
+*/
+
+SumType ShardedTree::rangeSum(const DataType& low, const DataType& high) const
+{
+	if (high < low) {
+		return 0;
+	}
+
+	int first;
+	int last;
+	lockRange(low, high, first, last);
+
+	SumType sum = 0;
+	for (int i = first; i <= last; i++) {
+		sum += _shards[i]->tree.rangeSum(low, high);
+	}
+
+	unlockRange(first, last);
+	return sum;
+}
+
+/**
+* Collect the items in the range [low, high] across the shards it overlaps
+*
+* Precondition: None
+* Postcondition: Every item x with low <= x <= high has been appended to
+*    result in increasing order
+*
+* Worst-Case Time Complexity: O(log s + r * h + k), where r is the number of
+*    shards overlapping the range and k is the number of items reported
+*/
+
+void ShardedTree::rangeScan(const DataType& low, const DataType& high, std::vector<DataType>& result) const
+{
+	if (high < low) {
+		return;
+	}
+
+	int first;
+	int last;
+	lockRange(low, high, first, last);
+
+	// shards are ordered by range, so per-shard scans concatenate in order
+	for (int i = first; i <= last; i++) {
+		_shards[i]->tree.rangeScan(low, high, result);
+	}
+
+	unlockRange(first, last);
+}
+
+/*****************************************************************************/
+/********************** Operations *******************************************/
+/*****************************************************************************/
+
+/**
+* Insert item into the forest
+*
+* Precondition: None
+* Postcondition: item has been inserted into the shard owning its range.
+*    Returns true if item was inserted and false if it was already present.
+*    The shard may have migrated part of its range to a neighbour
+*
+* Worst-Case Time Complexity: O(log s + h), plus O(s) for every
+*    REBALANCE_CHECK_INTERVAL inserts into a shard and a migration when the
+*    shard becomes skewed
+*/
+
+bool ShardedTree::insert(const DataType& item)
+{
+	int index = lockShard(item);
+	bool inserted;
+	bool checkSkew = false;
+	{
+		lock_guard<mutex> guard(_shards[index]->lock, adopt_lock);
+		inserted = _shards[index]->tree.insert(item);
+		if (inserted) {
+			_shards[index]->size++;
+			if (++_shards[index]->insertsSinceCheck >= REBALANCE_CHECK_INTERVAL) {
+				_shards[index]->insertsSinceCheck = 0;
+				checkSkew = true;
+			}
+		}
+	}
+
+	if (checkSkew) {
+		maybeRebalance(index);
+	}
+	return inserted;
+}
+
+/**
+* Remove item from the forest
+*
+* Precondition: None
+* Postcondition: item has been removed from the shard owning its range, if
+*    present. Returns true if item was removed and false otherwise
+*
+* Worst-Case Time Complexity: O(log s + h)
+*/
+
+bool ShardedTree::remove(const DataType& item)
+{
+	int index = lockShard(item);
+	lock_guard<mutex> guard(_shards[index]->lock, adopt_lock);
+
+	bool removed = _shards[index]->tree.remove(item);
+	if (removed) {
+		_shards[index]->size--;
+	}
+	return removed;
+}
+
+/**
+* Set how far a shard may grow past the average before it is rebalanced
+*
+* Precondition: factor is greater than 1
+* Postcondition: Shards holding more than factor times the average shard
+*    size migrate part of their range after an insert
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void ShardedTree::setSkewFactor(double factor)
+{
+	_skewFactor = factor;
+}
+
+/**
+* Rebalance the largest shard with its lighter neighbour
+*
+* Precondition: None
+* Postcondition: Part of the largest shard's range has been migrated to a
+*    neighbour if that reduces the skew. Returns true if any items moved
+*
+* Worst-Case Time Complexity: O(s + m * h), where m is the number of items
+*    moved
+*/
+
+bool ShardedTree::rebalance()
+{
+	int largest = 0;
+	for (size_t i = 1; i < _shards.size(); i++) {
+		if (_shards[i]->size.load() > _shards[largest]->size.load()) {
+			largest = (int)i;
+		}
+	}
+
+	return migrate(largest);
+}
+
+/*****************************************************************************/
+/********************** Functions ********************************************/
+/*****************************************************************************/
+
+/**
+* Find the shard whose range holds item using the current boundaries
+*
+* Precondition: None
+* Postcondition: Returns the index of the last shard whose lower bound is
+*    not greater than item (the first shard if there is none)
+*
+* Worst-Case Time Complexity: O(log s), where s is the number of shards
+*/
+
+int ShardedTree::route(const DataType& item) const
+{
+	int low = 0;
+	int high = (int)_shards.size() - 1;
+
+	while (low < high) {
+		int middle = low + (high - low + 1) / 2;
+		if (item < _shards[middle]->lowerBound.load()) {
+			high = middle - 1;
+		} else {
+			low = middle;
+		}
+	}
+
+	return low;
+}
+
+/**
+* Lock the shard that owns item. A boundary only moves while both shards on
+* either side of it are locked, so once the shard is locked its range is
+* stable and a stale routing decision can be detected and retried
+*
+* Precondition: The calling thread holds no shard locks
+* Postcondition: Returns the index of the shard owning item, with its lock
+*    held by the calling thread
+*
+* Worst-Case Time Complexity: O(log s) without contention
+*/
+
+int ShardedTree::lockShard(const DataType& item) const
+{
+	while (true) {
+		int index = route(item);
+		_shards[index]->lock.lock();
+
+		bool aboveLower = (index == 0 || !(item < _shards[index]->lowerBound.load()));
+		bool belowUpper = (index + 1 == (int)_shards.size() || item < _shards[index + 1]->lowerBound.load());
+		if (aboveLower && belowUpper) {
+			return index;
+		}
+
+		// a migration moved the boundary after routing
+		_shards[index]->lock.unlock();
+	}
+}
+
+/**
+* Lock the shards whose ranges overlap [low, high] in index order, the same
+* order migrations use. Boundaries between locked shards cannot move, so
+* only the two outer boundaries are re-checked, and the range is routed
+* again if a migration moved one of them first
+*
+* Precondition: low is not greater than high. The calling thread holds no
+*    shard locks
+* Postcondition: Shards first through last together own [low, high] and
+*    their locks are held by the calling thread
+*
+* Worst-Case Time Complexity: O(log s + r) without contention, where r is
+*    the number of shards locked
+*/
+
+void ShardedTree::lockRange(const DataType& low, const DataType& high, int &first, int &last) const
+{
+	while (true) {
+		first = route(low);
+		last = route(high);
+		for (int i = first; i <= last; i++) {
+			_shards[i]->lock.lock();
+		}
+
+		bool aboveLower = (first == 0 || !(low < _shards[first]->lowerBound.load()));
+		bool belowUpper = (last + 1 == (int)_shards.size() || high < _shards[last + 1]->lowerBound.load());
+		if (aboveLower && belowUpper) {
+			return;
+		}
+
+		unlockRange(first, last);
+	}
+}
+
+/**
+* Unlock the shards first through last
+*
+* Precondition: The calling thread holds the locks of shards first through
+*    last
+* Postcondition: Those locks are released
+*
+* Worst-Case Time Complexity: O(r), where r is the number of shards unlocked
+*/
+
+void ShardedTree::unlockRange(int first, int last) const
+{
+	for (int i = last; i >= first; i--) {
+		_shards[i]->lock.unlock();
+	}
+}
+
+/**
+* Migrate part of a shard's range if it has become skewed
+*
+* Precondition: The calling thread holds no shard locks
+* Postcondition: The shard has been rebalanced with a neighbour if it holds
+*    more than the skew factor times the average shard size
+*
+* Worst-Case Time Complexity: O(s), plus the migration
+*/
+
+void ShardedTree::maybeRebalance(int index)
+{
+	int size = _shards[index]->size.load();
+	if (size < MIN_REBALANCE_SIZE || _shards.size() < 2) {
+		return;
+	}
+
+	long long total = 0;
+	for (size_t i = 0; i < _shards.size(); i++) {
+		total += _shards[i]->size.load();
+	}
+
+	if (size > _skewFactor * total / _shards.size()) {
+		migrate(index);
+	}
+}
+
+/**
+* Move the boundary between a shard and its lighter neighbour so that half
+* of the difference in their sizes changes owner. Items leave the source
+* from the end adjacent to the neighbour: the boundary item is selected by
+* rank and the run is split off and joined onto the neighbour's tree
+*
+* Precondition: The calling thread holds no shard locks
+* Postcondition: Returns true if items were moved. Both shards' ranges and
+*    sizes are consistent
+*
+* Worst-Case Time Complexity: O(h + h'), where h and h' are the heights of
+*    the two shards' trees
+*/
+
+bool ShardedTree::migrate(int index)
+{
+	int count = (int)_shards.size();
+	if (count < 2) {
+		return false;
+	}
+
+	// pick the lighter neighbour
+	int neighbour;
+	if (index == 0) {
+		neighbour = 1;
+	} else if (index == count - 1) {
+		neighbour = index - 1;
+	} else if (_shards[index - 1]->size.load() <= _shards[index + 1]->size.load()) {
+		neighbour = index - 1;
+	} else {
+		neighbour = index + 1;
+	}
+
+	// lock in index order to avoid deadlock with other migrations
+	int first = (index < neighbour) ? index : neighbour;
+	lock_guard<mutex> firstGuard(_shards[first]->lock);
+	lock_guard<mutex> secondGuard(_shards[first + 1]->lock);
+
+	Shard * source = _shards[index];
+	Shard * target = _shards[neighbour];
+
+	// sizes may have changed before the locks were taken
+	int moving = (source->tree.getSize() - target->tree.getSize()) / 2;
+	if (moving <= 0) {
+		return false;
+	}
+
+	// the moving items are the source's lowest or highest, found by rank,
+	// and move as whole subtrees
+	DataType low;
+	DataType high;
+	if (neighbour < index) {
+		low = source->tree.getMinimum();
+		source->tree.getByRank(moving - 1, high);
+	} else {
+		source->tree.getByRank(source->tree.getSize() - moving, low);
+		high = source->tree.getMaximum();
+	}
+	source->tree.extractRange(low, high, target->tree);
+
+	// the boundary now sits at the edge of what remains in the source
+	if (neighbour < index) {
+		source->lowerBound.store(source->tree.getMinimum());
+	} else {
+		target->lowerBound.store(target->tree.getMinimum());
+	}
+
+	source->size.store(source->tree.getSize());
+	target->size.store(target->tree.getSize());
+
+	return true;
+}
@@ -0,0 +1,81 @@
+#ifndef SHARDEDTREE_H_
+#define SHARDEDTREE_H_
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "bst.h"
+
+const double DEFAULT_SKEW_FACTOR = 2.0;
+const int MIN_REBALANCE_SIZE = 64;
+const int REBALANCE_CHECK_INTERVAL = 1024; // inserts into a shard between skew checks
+const int CACHE_LINE_SIZE = 64;
+
+/**
+ * Class to hold a range-partitioned forest of binary search trees
+ *
+ * The key space is split into a fixed number of contiguous ranges. Each
+ * shard owns the tree and the lock for its range, so writers to different
+ * ranges never contend. Shard boundaries are read without locking when
+ * routing and re-checked under the shard lock; they sit on their own cache
+ * line, away from the lock and counters that writers update. Every
+ * REBALANCE_CHECK_INTERVAL inserts a shard compares its size with the
+ * others. When it has grown past the skew factor times the average shard
+ * size, part of its range is migrated to its lighter neighbour by moving
+ * the boundary between them
+ *
+ * Note that, like BinarySearchTree, all items must be unique
+ */
+
+class ShardedTree {
+   private:
+      class Shard {
+         public:
+            BinarySearchTree tree;
+            std::mutex lock;
+            std::atomic<int> size;
+            int insertsSinceCheck;            // guarded by lock
+            char ownerPadding[CACHE_LINE_SIZE];
+            std::atomic<DataType> lowerBound; // smallest key routed here
+            char routerPadding[CACHE_LINE_SIZE];
+
+            Shard(const DataType& low):size(0),insertsSinceCheck(0),lowerBound(low) {};
+      };
+   public:
+      ShardedTree(const DataType&, const DataType&, int);
+
+      ~ShardedTree();
+
+      bool search(const DataType&) const;
+      int getSize() const;
+      int getShardCount() const;
+      int getShardSize(int) const;
+
+      int rangeCount(const DataType&, const DataType&) const;
+      SumType rangeSum(const DataType&, const DataType&) const;
+      void rangeScan(const DataType&, const DataType&, std::vector<DataType>&) const;
+
+      bool insert(const DataType&);
+      bool remove(const DataType&);
+
+      void setSkewFactor(double);
+      bool rebalance();
+
+   private:
+      std::vector<Shard *> _shards;
+      double _skewFactor;
+
+      int route(const DataType&) const;
+      int lockShard(const DataType&) const;
+      void lockRange(const DataType&, const DataType&, int &, int &) const;
+      void unlockRange(int, int) const;
+
+      void maybeRebalance(int);
+      bool migrate(int);
+
+      // shards hold locks, so the forest is not copyable
+      ShardedTree(const ShardedTree&);
+      ShardedTree& operator=(const ShardedTree&);
+};
+
+#endif /* SHARDEDTREE_H_ */
@@ -0,0 +1,98 @@
+#ifndef STATICTREE_H_
+#define STATICTREE_H_
+
+#include "bst.h"
+
+/**
+ * Class to hold a search tree over a key set fixed at compile time
+ *
+ * The keys are stored as a sorted constexpr array, which is an implicit
+ * perfectly balanced binary search tree: the middle of any range is the
+ * root of that range. Nothing is built at startup and nothing is allocated,
+ * every query is a constexpr function, and with the size known at compile
+ * time the compiler can fully unroll the O(log n) descent. For example
+ *
+ *    typedef StaticSearchTree<-10, -1, 1, 6, 11, 100> Codes;
+ *    static_assert(Codes::search(6), "6 is a code");
+ *
+ * Queries follow bst.h: getSuccessor and getPredecessor expect a present
+ * item, and return DataType() where BinarySearchTree returns garbage
+ *
+ * Note that the keys must be listed in strictly increasing order
+ */
+
+template <DataType... Keys>
+class StaticSearchTree {
+   public:
+      static constexpr int SIZE = sizeof...(Keys);
+      static constexpr DataType keys[SIZE] = { Keys... };
+
+      static constexpr bool isEmpty() { return false; }
+      static constexpr int getSize() { return SIZE; }
+
+      /**
+      * Search the tree for an item
+      *
+      * Worst-Case Time Complexity: O(log n)
+      */
+      static constexpr bool search(const DataType& item)
+      {
+         return lowerBound(item, 0, SIZE) < SIZE && keys[lowerBound(item, 0, SIZE)] == item;
+      }
+
+      /**
+      * Determine the inorder successor of item, or DataType() if item is
+      * absent or the maximum
+      *
+      * Worst-Case Time Complexity: O(log n)
+      */
+      static constexpr DataType getSuccessor(const DataType& item)
+      {
+         return (search(item) && lowerBound(item, 0, SIZE) + 1 < SIZE)
+            ? keys[lowerBound(item, 0, SIZE) + 1] : DataType();
+      }
+
+      /**
+      * Determine the inorder predecessor of item, or DataType() if item is
+      * absent or the minimum
+      *
+      * Worst-Case Time Complexity: O(log n)
+      */
+      static constexpr DataType getPredecessor(const DataType& item)
+      {
+         return (search(item) && lowerBound(item, 0, SIZE) > 0)
+            ? keys[lowerBound(item, 0, SIZE) - 1] : DataType();
+      }
+
+      static constexpr DataType getMinimum() { return keys[0]; }
+      static constexpr DataType getMaximum() { return keys[SIZE - 1]; }
+
+   private:
+      /**
+      * Position of the first key not less than item within [low, high)
+      */
+      static constexpr int lowerBound(const DataType& item, int low, int high)
+      {
+         return (low >= high) ? low
+            : (keys[low + (high - low) / 2] < item)
+               ? lowerBound(item, low + (high - low) / 2 + 1, high)
+               : lowerBound(item, low, low + (high - low) / 2);
+      }
+
+      /**
+      * Check that the keys are strictly increasing
+      */
+      static constexpr bool isSorted(int index)
+      {
+         return (index + 1 >= SIZE) || (keys[index] < keys[index + 1] && isSorted(index + 1));
+      }
+
+      static_assert(sizeof...(Keys) > 0, "a static search tree needs at least one key");
+      static_assert(isSorted(0), "static search tree keys must be strictly increasing");
+};
+
+// out-of-class definition so keys can be used at run time as well
+template <DataType... Keys>
+constexpr DataType StaticSearchTree<Keys...>::keys[StaticSearchTree<Keys...>::SIZE];
+
+#endif /* STATICTREE_H_ */
@@ -0,0 +1,315 @@
+#include "traversalsink.h"
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+using namespace std;
+
+// two-digit lookup table for integer-to-text conversion
+static const char DIGIT_PAIRS[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/*****************************************************************************/
+/********************** Constructors *****************************************/
+/*****************************************************************************/
+
+/**
+* Construct a sink that writes to a file descriptor
+*
+* Precondition: fd is open for writing. capacity is positive
+* Postcondition: A sink with an owned buffer of capacity bytes has been
+*    constructed. Output is written to fd whenever the buffer fills
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+TraversalSink::TraversalSink(int fd, SinkFormat format, int capacity)
+{
+	_fd = fd;
+	_buffer = new char[capacity];
+	_capacity = capacity;
+	_length = 0;
+	_written = 0;
+	_ownsBuffer = true;
+	_failed = false;
+	_format = format;
+}
+
+/**
+* Construct a sink that writes into a caller-supplied buffer
+*
+* Precondition: buffer points to at least capacity writable bytes
+* Postcondition: A sink that fills buffer has been constructed. Output that
+*    does not fit is dropped and the sink is marked as failed
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+TraversalSink::TraversalSink(char * buffer, int capacity, SinkFormat format)
+{
+	_fd = -1;
+	_buffer = buffer;
+	_capacity = capacity;
+	_length = 0;
+	_written = 0;
+	_ownsBuffer = false;
+	_failed = false;
+	_format = format;
+}
+
+/*****************************************************************************/
+/********************** Destructor *******************************************/
+/*****************************************************************************/
+
+/**
+* Destructor for a traversal sink
+*
+* Precondition: The life of the sink is over
+* Postcondition: Buffered output has been written to the file descriptor and
+*    an owned buffer has been freed
+*
+* Worst-Case Time Complexity: O(1), plus one write of the buffered output
+*/
+
+TraversalSink::~TraversalSink()
+{
+	flush();
+	if (_ownsBuffer) {
+		delete [] _buffer;
+	}
+}
+
+/*****************************************************************************/
+/********************** Accessors ********************************************/
+/*****************************************************************************/
+
+/**
+* Determine the number of bytes held in the buffer
+*
+* Precondition: None
+* Postcondition: Returns the number of bytes in the buffer. For a sink over a
+*    caller-supplied buffer this is the length of the output
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+int TraversalSink::getLength() const
+{
+	return _length;
+}
+
+/**
+* Determine the number of bytes written to the file descriptor
+*
+* Precondition: None
+* Postcondition: Returns the number of bytes flushed so far
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+long long TraversalSink::getBytesWritten() const
+{
+	return _written;
+}
+
+/**
+* Check if output has been lost
+*
+* Precondition: None
+* Postcondition: Returns true if a write failed or a caller-supplied buffer
+*    overflowed
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+bool TraversalSink::hasFailed() const
+{
+	return _failed;
+}
+
+/*****************************************************************************/
+/********************** Operations *******************************************/
+/*****************************************************************************/
+
+/**
+* Output one value in the sink's format
+*
+* Precondition: None
+* Postcondition: item has been appended to the output
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void TraversalSink::put(const DataType& item)
+{
+	// longest record is {"key":-9223372036854775808}\n
+	char record[40];
+	int length = 0;
+
+	switch (_format) {
+	case FORMAT_BINARY:
+		append(reinterpret_cast<const char *>(&item), sizeof(DataType));
+		return;
+	case FORMAT_TEXT:
+		length = formatInteger(item, record);
+		record[length++] = ',';
+		record[length++] = ' ';
+		break;
+	case FORMAT_CSV:
+		length = formatInteger(item, record);
+		record[length++] = '\n';
+		break;
+	case FORMAT_JSON_LINES:
+		memcpy(record, "{\"key\":", 7);
+		length = 7 + formatInteger(item, record + 7);
+		record[length++] = '}';
+		record[length++] = '\n';
+		break;
+	}
+
+	append(record, length);
+}
+
+/**
+* Mark the end of a traversal
+*
+* Precondition: None
+* Postcondition: The text format has been terminated with a newline. Other
+*    formats are line- or record-delimited already and are unchanged
+*
+* Worst-Case Time Complexity: O(1)
+*/
+
+void TraversalSink::endTraversal()
+{
+	if (_format == FORMAT_TEXT) {
+		append("\n", 1);
+	}
+}
+
+/**
+* Write buffered output to the file descriptor
+*
+* Precondition: None
+* Postcondition: The buffer is empty if the sink writes to a file
+*    descriptor. Returns false if any write has failed
+*
+* Worst-Case Time Complexity: O(b), where b is the size of the buffer
+*/
+
+bool TraversalSink::flush()
+{
+	if (_fd < 0) {
+		return !_failed;
+	}
+
+	int offset = 0;
+	while (offset < _length) {
+		ssize_t count = ::write(_fd, _buffer + offset, _length - offset);
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			_failed = true;
+			break;
+		}
+		offset += (int)count;
+	}
+
+	_written += offset;
+	_length = 0;
+
+	return !_failed;
+}
+
+/*****************************************************************************/
+/********************** Functions ********************************************/
+/*****************************************************************************/
+
+/**
+* Append bytes to the buffer, flushing to the file descriptor when full
+*
+* Precondition: bytes points to length readable bytes
+* Postcondition: bytes have been appended, or dropped and the sink marked as
+*    failed if a caller-supplied buffer is full
+*
+* Worst-Case Time Complexity: O(length), plus a write when the buffer fills
+*/
+
+void TraversalSink::append(const char * bytes, int length)
+{
+	if (_fd < 0) {
+		if (_length + length > _capacity) {
+			_failed = true;
+			return;
+		}
+		memcpy(_buffer + _length, bytes, length);
+		_length += length;
+		return;
+	}
+
+	// copy in chunks so records larger than the buffer are still written
+	while (length > 0) {
+		if (_length == _capacity) {
+			flush();
+		}
+		int chunk = _capacity - _length;
+		if (chunk > length) {
+			chunk = length;
+		}
+		memcpy(_buffer + _length, bytes, chunk);
+		_length += chunk;
+		bytes += chunk;
+		length -= chunk;
+	}
+}
+
+/**
+* Convert an integer to decimal text two digits at a time
+*
+* Precondition: text has room for 20 characters
+* Postcondition: The decimal form of value has been written to text without
+*    a terminator. Returns the number of characters written
+*
+* Worst-Case Time Complexity: O(d), where d is the number of digits
+*/
+
+int TraversalSink::formatInteger(long long value, char * text) const
+{
+	char digits[20];
+	int position = 20;
+
+	// work in unsigned arithmetic so the most negative value is handled
+	unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+
+	while (magnitude >= 100) {
+		int pair = (int)(magnitude % 100) * 2;
+		magnitude /= 100;
+		digits[--position] = DIGIT_PAIRS[pair + 1];
+		digits[--position] = DIGIT_PAIRS[pair];
+	}
+	if (magnitude >= 10) {
+		int pair = (int)magnitude * 2;
+		digits[--position] = DIGIT_PAIRS[pair + 1];
+		digits[--position] = DIGIT_PAIRS[pair];
+	} else {
+		digits[--position] = (char)('0' + magnitude);
+	}
+
+	int length = 0;
+	if (value < 0) {
+		text[length++] = '-';
+	}
+	memcpy(text + length, digits + position, 20 - position);
+
+	return length + 20 - position;
+}
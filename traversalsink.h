@@ -0,0 +1,60 @@
+#ifndef TRAVERSALSINK_H_
+#define TRAVERSALSINK_H_
+
+#include "bst.h"
+
+const int DEFAULT_SINK_BUFFER = 1 << 16;
+
+/**
+ * Output formats understood by a traversal sink
+ *
+ * FORMAT_TEXT        "1, 2, 3, " followed by a newline, like inorder(ostream&)
+ * FORMAT_CSV         one value per line
+ * FORMAT_JSON_LINES  one {"key":value} object per line
+ * FORMAT_BINARY      raw DataType values in native byte order
+ */
+
+enum SinkFormat { FORMAT_TEXT, FORMAT_CSV, FORMAT_JSON_LINES, FORMAT_BINARY };
+
+/**
+ * Class to collect traversal output without going through iostreams
+ *
+ * Values are formatted with a hand-written integer-to-text conversion into
+ * a buffer. A sink either writes into a caller-supplied memory buffer, or
+ * owns a buffer that is written to a file descriptor in large chunks
+ */
+
+class TraversalSink {
+   public:
+      TraversalSink(int, SinkFormat, int = DEFAULT_SINK_BUFFER);
+      TraversalSink(char *, int, SinkFormat);
+
+      ~TraversalSink();
+
+      void put(const DataType&);
+      void endTraversal();
+      bool flush();
+
+      int getLength() const;
+      long long getBytesWritten() const;
+      bool hasFailed() const;
+
+   private:
+      int _fd;
+      char * _buffer;
+      int _capacity;
+      int _length;
+      long long _written;
+      bool _ownsBuffer;
+      bool _failed;
+      SinkFormat _format;
+
+      void append(const char *, int);
+      int formatInteger(long long, char *) const;
+
+      // sinks own or borrow a raw buffer, so they are not copyable
+      TraversalSink(const TraversalSink&);
+      TraversalSink& operator=(const TraversalSink&);
+};
+
+#endif /* TRAVERSALSINK_H_ */